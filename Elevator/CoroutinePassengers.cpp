@@ -0,0 +1,163 @@
+// CMP202
+// Elevator System Simulation
+// Coroutine passengers -- each passenger is a C++20 coroutine instead of a thread, run by a small fixed pool of workers
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "CoroutinePassengers.h"
+using namespace std;
+
+WorkerPool::WorkerPool(unsigned int workers) {
+    workers = max(1u, workers); // With no worker, nothing would resume the coroutines and resumeAndWait() would never return
+    for (unsigned int i = 0; i < workers; i++) {
+        threads.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void WorkerPool::schedule(coroutine_handle<> handle) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        queue.push_back(handle);
+    }
+    queueReady.notify_one();
+}
+
+void WorkerPool::schedule(const vector<coroutine_handle<>>& handles) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        queue.insert(queue.end(), handles.begin(), handles.end());
+    }
+    queueReady.notify_all();
+}
+
+void WorkerPool::run() {
+    while (true) {
+        coroutine_handle<> handle;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // Stopping and nothing left to run.
+            handle = queue.front();
+            queue.pop_front();
+        }
+        handle.resume(); // Runs the passenger until its next co_await (or until it finishes).
+    }
+}
+
+void CoroutineBuilding::FloorEvent::await_suspend(coroutine_handle<> handle) {
+    // Once the handle is in a list another thread may resume and destroy this coroutine, including this awaiter,
+    // so everything needed afterwards is copied onto the stack first.
+    CoroutineBuilding& b = building;
+    bool finishingStop = !boarding; // A passenger waiting for its destination has just boarded at the current stop.
+    {
+        lock_guard<mutex> lock(b.floorMutex[floor]);
+        if (boarding) b.waitingToBoard[floor].push_back(handle);
+        else b.waitingToExit[floor].push_back(handle);
+    }
+    if (finishingStop) b.stopDone();
+}
+
+void CoroutineBuilding::stopDone() {
+    if (pendingAtStop.fetch_sub(1) == 1) {
+        pendingAtStop.notify_one(); // The last passenger at this stop lets the elevator move on.
+    }
+}
+
+void CoroutineBuilding::resumeAndWait(const vector<coroutine_handle<>>& handles) {
+    if (handles.empty()) return;
+    pendingAtStop = static_cast<int>(handles.size());
+    pool.schedule(handles);
+    int pending;
+    while ((pending = pendingAtStop.load()) != 0) {
+        pendingAtStop.wait(pending);
+    }
+}
+
+void CoroutineBuilding::stopAt(int floor) {
+    // Passengers get off first, which frees room in the elevator.
+    vector<coroutine_handle<>> exiting;
+    {
+        lock_guard<mutex> lock(floorMutex[floor]);
+        exiting.swap(waitingToExit[floor]);
+    }
+    resumeAndWait(exiting);
+
+    // Only as many waiting passengers as there is room for are woken, so none of them ever blocks a worker in
+    // elevatorCapacity.acquire(); the rest stay suspended until the next visit.
+    vector<coroutine_handle<>> boarding;
+    {
+        lock_guard<mutex> lock(floorMutex[floor]);
+        int room = MAX_CAPACITY - passengersInElevator.load();
+        auto& waiting = waitingToBoard[floor];
+        while (room-- > 0 && !waiting.empty()) {
+            boarding.push_back(waiting.front());
+            waiting.pop_front();
+        }
+    }
+    resumeAndWait(boarding);
+}
+
+PassengerTask coroutinePassenger(CoroutineBuilding& building, int startFloor, int destinationFloor) {
+    // Wait for the elevator to arrive at the start floor.
+    co_await building.elevatorAt(startFloor);
+
+    // Boarding: there is always room here, because the elevator only wakes as many passengers as can fit.
+    elevatorCapacity.acquire();
+    passengersInElevator++;
+
+    // Waits for the elevator to reach the destination floor (this also tells the elevator boarding is complete).
+    co_await building.elevatorAtDestination(destinationFloor);
+
+    // Exiting the elevator
+    passengersInElevator--;
+    elevatorCapacity.release();
+    building.delivered++;
+    building.stopDone();
+}
+
+void runCoroutineSimulation(long long passengers, unsigned int workers) {
+    CoroutineBuilding building(workers);
+
+    mt19937 rng(42); // Fixed seed so runs can be compared.
+    uniform_int_distribution<int> uni(0, TOTAL_LEVELS - 1);
+
+    auto start = chrono::steady_clock::now();
+    for (long long i = 0; i < passengers; i++) {
+        int startFloor = uni(rng);
+        int destinationFloor;
+        do {
+            destinationFloor = uni(rng); // Ensures destination floor is different from start floor.
+        } while (destinationFloor == startFloor);
+        building.start(coroutinePassenger(building, startFloor, destinationFloor));
+    }
+
+    // The elevator sweeps the building without sleeping, stopping at every floor, until everyone is delivered.
+    long long moves = 0;
+    int level = currentLevel;
+    building.stopAt(level);
+    while (building.delivered < passengers) {
+        level += movingUp ? 1 : -1;
+        if (level == 0 || level == TOTAL_LEVELS - 1) movingUp = !movingUp;
+        currentLevel = level;
+        building.stopAt(level);
+        moves++;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Delivered " << building.delivered << " coroutine passengers with " << workers << " worker threads in "
+        << seconds << " s (" << moves << " elevator moves)" << endl;
+}
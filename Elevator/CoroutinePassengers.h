@@ -0,0 +1,97 @@
+// CMP202
+// Elevator System Simulation
+// Coroutine passengers -- each passenger is a C++20 coroutine instead of a thread, run by a small fixed pool of workers
+
+#ifndef COROUTINE_PASSENGERS_H
+#define COROUTINE_PASSENGERS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Elevator.h"
+
+// Return type of a passenger coroutine. The coroutine starts suspended, so that it can be handed to the worker pool,
+// and destroys its own frame when it finishes.
+struct PassengerTask {
+    struct promise_type {
+        PassengerTask get_return_object() { return PassengerTask{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle; // Handle used to start the coroutine
+};
+
+// A fixed number of worker threads that resume suspended coroutines.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned int workers); // At least 1 worker is started
+    ~WorkerPool(); // Finishes the queued coroutines and joins the workers
+
+    void schedule(std::coroutine_handle<> handle); // Queues one coroutine to be resumed by a worker
+    void schedule(const std::vector<std::coroutine_handle<>>& handles); // Queues a batch of coroutines at once
+
+private:
+    void run(); // Worker loop
+
+    std::mutex queueMutex; // Protects queue and stopping
+    std::condition_variable queueReady; // Signalled when coroutines are queued or the pool is stopping
+    std::deque<std::coroutine_handle<>> queue; // Coroutines waiting to be resumed
+    bool stopping = false; // Set by the destructor to make the workers exit
+    std::vector<std::thread> threads; // The worker threads
+};
+
+// The building as seen by coroutine passengers: per-floor lists of passengers suspended until the elevator reaches
+// their start floor ("elevator at floor N") or their destination ("elevator at destination").
+class CoroutineBuilding {
+public:
+    explicit CoroutineBuilding(unsigned int workers) : pool(workers) {}
+
+    // Awaitable that suspends the passenger until the elevator stops at the given floor.
+    struct FloorEvent {
+        CoroutineBuilding& building;
+        int floor;
+        bool boarding; // True when waiting to board at the start floor, false when riding to the destination
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    FloorEvent elevatorAt(int floor) { return FloorEvent{ *this, floor, true }; }
+    FloorEvent elevatorAtDestination(int floor) { return FloorEvent{ *this, floor, false }; }
+
+    void stopAt(int floor); // Called by the elevator: lets passengers off, then on as far as there is room, and waits for them
+    void stopDone(); // Called by a passenger when it has finished getting on or off at the current stop
+
+    void start(PassengerTask task) { pool.schedule(task.handle); } // Starts a passenger coroutine on the worker pool
+
+    std::atomic<long long> delivered{ 0 }; // Number of passengers that have reached their destination
+
+private:
+    void resumeAndWait(const std::vector<std::coroutine_handle<>>& handles); // Resumes a batch and waits for stopDone() from each
+
+    std::mutex floorMutex[TOTAL_LEVELS]; // Protects the per-floor lists below
+    std::deque<std::coroutine_handle<>> waitingToBoard[TOTAL_LEVELS]; // Passengers waiting at each floor, in arrival order
+    std::vector<std::coroutine_handle<>> waitingToExit[TOTAL_LEVELS]; // Passengers riding to each floor
+    std::atomic<int> pendingAtStop{ 0 }; // Passengers resumed at the current stop that have not called stopDone() yet
+
+    WorkerPool pool; // Declared last so the workers are joined before anything they use is destroyed
+};
+
+// Passenger behaviour as a coroutine: wait at the start floor, board within the elevatorCapacity limit,
+// wait for the destination, exit.
+PassengerTask coroutinePassenger(CoroutineBuilding& building, int startFloor, int destinationFloor);
+
+// Runs the simulation with the given number of coroutine passengers and worker threads, without display.
+void runCoroutineSimulation(long long passengers, unsigned int workers);
+
+#endif
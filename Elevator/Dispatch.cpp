@@ -0,0 +1,99 @@
+// CMP202
+// Elevator System Simulation
+// Elevator cars and the dispatch policies that decide which car serves a request and where each car goes next
+
+#include <cstdlib>
+#include <limits>
+
+#include "Dispatch.h"
+#include "EventSimulation.h"
+using namespace std;
+
+bool Elevator::hasStopAt(int floor, const EventSimulation& sim, bool servesOpenCalls) const {
+    return riderStops[floor] > 0 || assignedCalls[floor] > 0 || (servesOpenCalls && sim.openCallsAt(floor) > 0);
+}
+
+// LOOK movement shared by the policies: keep the current direction while the car has stops beyond its floor.
+static int lookMove(const EventSimulation& sim, const Elevator& car, bool servesOpenCalls) {
+    bool above = false, below = false;
+    for (int f = car.level + 1; f < sim.config().levels && !above; f++) above = car.hasStopAt(f, sim, servesOpenCalls);
+    for (int f = car.level - 1; f >= 0 && !below; f--) below = car.hasStopAt(f, sim, servesOpenCalls);
+
+    if (car.movingUp) return above ? 1 : (below ? -1 : 0);
+    return below ? -1 : (above ? 1 : 0);
+}
+
+// Number of floors the car travels before reaching the floor, assuming it runs to the end of its current direction
+// before turning round.
+static int floorsToReach(const EventSimulation& sim, const Elevator& car, int floor) {
+    int top = sim.config().levels - 1;
+    if (car.idle || car.level == floor) return abs(car.level - floor);
+    if (car.movingUp) return floor >= car.level ? floor - car.level : (top - car.level) + (top - floor);
+    return floor <= car.level ? car.level - floor : car.level + floor;
+}
+
+int SweepDispatcher::nextMove(const EventSimulation& sim, const Elevator& car) {
+    int top = sim.config().levels - 1;
+    if (top == 0) return 0; // A single floor: there is nowhere to go
+    if (car.level >= top) return -1;
+    if (car.level <= 0) return 1;
+    return car.movingUp ? 1 : -1;
+}
+
+int LookDispatcher::nextMove(const EventSimulation& sim, const Elevator& car) {
+    return lookMove(sim, car, true);
+}
+
+int NearestCarDispatcher::assign(const EventSimulation& sim, const SimPassenger& passenger) {
+    int best = 0, bestDistance = numeric_limits<int>::max();
+    for (const Elevator& car : sim.cars()) {
+        int distance = floorsToReach(sim, car, passenger.startFloor);
+        if (distance < bestDistance) {
+            best = car.id;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+int NearestCarDispatcher::nextMove(const EventSimulation& sim, const Elevator& car) {
+    return lookMove(sim, car, false);
+}
+
+int DestinationDispatcher::assign(const EventSimulation& sim, const SimPassenger& passenger) {
+    const SimulationConfig& config = sim.config();
+    int best = 0;
+    SimTime bestCost = numeric_limits<SimTime>::max();
+    for (const Elevator& car : sim.cars()) {
+        SimTime cost = floorsToReach(sim, car, passenger.startFloor) * config.moveDuration;
+        // Every stop the car does not already make costs everyone on board a stop.
+        bool stopsAtStart = car.riderStops[passenger.startFloor] > 0 || car.assignedCalls[passenger.startFloor] > 0;
+        bool stopsAtDestination = car.riderStops[passenger.destinationFloor] > 0 || car.assignedDestinations[passenger.destinationFloor] > 0;
+        if (!stopsAtStart) cost += config.stopDuration * (1 + static_cast<SimTime>(car.riders.size()));
+        if (!stopsAtDestination) cost += config.stopDuration * (1 + static_cast<SimTime>(car.riders.size()));
+        // A car that is already fully booked would have to come back for this passenger.
+        if (static_cast<int>(car.riders.size()) + car.assignedTotal >= config.capacity) cost += 2 * (config.levels - 1) * config.moveDuration;
+        if (cost < bestCost) {
+            best = car.id;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+int DestinationDispatcher::nextMove(const EventSimulation& sim, const Elevator& car) {
+    return lookMove(sim, car, false);
+}
+
+unique_ptr<Dispatcher> makeDispatcher(const string& name) {
+    if (name == "sweep") return make_unique<SweepDispatcher>();
+    if (name == "look") return make_unique<LookDispatcher>();
+    if (name == "nearest-car") return make_unique<NearestCarDispatcher>();
+    if (name == "destination") return make_unique<DestinationDispatcher>();
+    return nullptr;
+}
+
+const vector<string>& dispatcherNames() {
+    static const vector<string> names = { "sweep", "look", "nearest-car", "destination" };
+    return names;
+}
@@ -0,0 +1,87 @@
+// CMP202
+// Elevator System Simulation
+// Elevator cars and the dispatch policies that decide which car serves a request and where each car goes next
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class EventSimulation;
+struct SimPassenger;
+
+// The state of one elevator car in the discrete-event simulation.
+class Elevator {
+public:
+    Elevator(int id, int levels) : id(id), riderStops(levels), assignedCalls(levels), assignedDestinations(levels) {}
+
+    int id;
+    int level = 0; // Current floor, starting at ground floor (0)
+    bool movingUp = true; // Direction of movement
+    bool idle = false; // True while the car stands at a floor with nothing to do
+    std::vector<int> riders; // Passengers inside the car
+    std::vector<int> riderStops; // Number of riders going to each floor
+    std::vector<int> assignedCalls; // Number of waiting passengers assigned to this car, per start floor
+    std::vector<int> assignedDestinations; // Number of waiting passengers assigned to this car, per destination floor
+    int assignedTotal = 0; // Number of waiting passengers assigned to this car
+
+    // True if the car has a reason to stop at the given floor (a rider's destination or a call it serves).
+    bool hasStopAt(int floor, const EventSimulation& sim, bool servesOpenCalls) const;
+};
+
+// A dispatch policy. The simulation asks it which car should serve a new passenger, and which way a car should go
+// when it is ready to leave a floor.
+class Dispatcher {
+public:
+    virtual ~Dispatcher() = default;
+
+    virtual std::string name() const = 0;
+
+    // Returns the car that will pick up this passenger, or -1 to leave the call open to any car.
+    virtual int assign(const EventSimulation& /*sim*/, const SimPassenger& /*passenger*/) { return -1; }
+
+    // Returns +1 to move up, -1 to move down or 0 to stay idle at the current floor.
+    virtual int nextMove(const EventSimulation& sim, const Elevator& car) = 0;
+};
+
+// The original behaviour: sweep from the bottom to the top floor and back whether or not anyone is waiting.
+class SweepDispatcher : public Dispatcher {
+public:
+    std::string name() const override { return "sweep"; }
+    int nextMove(const EventSimulation& sim, const Elevator& car) override;
+};
+
+// LOOK: keep going while there are requests further on in the current direction, then reverse; idle when there are none.
+// Calls are open to every car.
+class LookDispatcher : public Dispatcher {
+public:
+    std::string name() const override { return "look"; }
+    int nextMove(const EventSimulation& sim, const Elevator& car) override;
+};
+
+// Nearest car: each hall call is assigned to the car that would reach it first, which then serves it with LOOK.
+class NearestCarDispatcher : public Dispatcher {
+public:
+    std::string name() const override { return "nearest-car"; }
+    int assign(const EventSimulation& sim, const SimPassenger& passenger) override;
+    int nextMove(const EventSimulation& sim, const Elevator& car) override;
+};
+
+// Destination dispatch: passengers enter their destination before boarding, so calls are assigned by the estimated
+// cost of the whole trip, which groups passengers with the same start and destination into the same car.
+class DestinationDispatcher : public Dispatcher {
+public:
+    std::string name() const override { return "destination"; }
+    int assign(const EventSimulation& sim, const SimPassenger& passenger) override;
+    int nextMove(const EventSimulation& sim, const Elevator& car) override;
+};
+
+// Creates a dispatcher by name ("sweep", "look", "nearest-car" or "destination"). Returns nullptr for an unknown name.
+std::unique_ptr<Dispatcher> makeDispatcher(const std::string& name);
+
+// Names accepted by makeDispatcher(), in the order they are compared.
+const std::vector<std::string>& dispatcherNames();
+
+#endif
@@ -11,15 +11,22 @@
 #include <semaphore>
 #include <atomic>
 #include <chrono>
-#include <map>
+#include <deque>
 #include <random> 
-using namespace std;
+#include <string>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
 
-// Constants to define the elevator system's properties
-constexpr int TOTAL_LEVELS = 10; // Total number of floors in the building
-constexpr int MAX_CAPACITY = 3; // Maximum number of passengers the elevator can hold
-constexpr int MOVE_DURATION = 2000; // Time in milliseconds it takes the elevator to move between floors
-constexpr int STOP_DURATION = 500; // Time in milliseconds for the elevator to stop at a floor (not used here)
+#include "Elevator.h"
+#include "CoroutinePassengers.h"
+#include "EventSimulation.h"
+#include "FloorQueues.h"
+#include "Metrics.h"
+#include "Renderer.h"
+#include "Sweep.h"
+#include "Workload.h"
+using namespace std;
 
 // Global synchronization primitives and variables
 // Semaphore to limit elevator capacity -- Todo Task 2
@@ -27,69 +34,49 @@ std::atomic<int> currentLevel(0); // Current floor of the elevator, starting at
 std::atomic<bool> movingUp(true); // Direction of elevator movement, initially set to move up 
 
 std::atomic<int> passengersInElevator(0); // Number of passengers currently in the elevator
-std::mutex coutMutex; // Mutex for synchronizing access to console output
-std::mutex elevatorMutex; // Mutex for synchronizing access to elevator-specific operations
-
-// Data structures for tracking passengers
-vector<pair<int, int>> passengersInsideElevator; // Vector to keep track of passengers inside the elevator (ID, destination floor)
-std::mutex passengersInsideElevatorMutex; // Mutex for synchronizing access to the passengersInsideElevator vector
-map<int, vector<pair<int, int>>> pickupRequests; // Map to hold pickup requests per floor (floor number, vector of (ID, destination floor))
-std::mutex pickupRequestsMutex; // Mutex for synchronizing access to pickup requests
-map<int, vector<pair<int, int>>> deliveredPassengers; // Map to hold delivered passengers per floor
-std::mutex deliveredPassengersMutex; // Mutex for synchronizing access to deliveredPassengers map
-
-std::counting_semaphore<MAX_CAPACITY> elevatorCapacity(MAX_CAPACITY);
-
-// Function to clear the console. The implementation depends on the operating system
-void clearConsole() {
-#ifdef _WIN32
-    system("cls"); // Clears console on Windows systems
-#else
-    system("clear"); // Clears console on Unix/Linux systems
-#endif
-}
-// Function to print the current state of the building and elevator.
-void printBuilding() {
-    lock_guard<mutex> lock(coutMutex); // Ensures exclusive access to std::cout.
-    clearConsole(); // Clears the console for a fresh display of the building state.
-    for (int i = TOTAL_LEVELS - 1; i >= 0; --i) { // Iterates over each floor from top to bottom.
-        cout << "Floor " << i << ": ";
-        if (i == currentLevel) { // Checks if the elevator is at the current floor.
-            // Displays the elevator's status, direction, and passenger count.
-            cout << "[E: ";
-            cout << (movingUp ? "Up" : "Down") << ", P: " << passengersInElevator.load() << "/" << MAX_CAPACITY << " ";
-            for (size_t index = 0; index < passengersInsideElevator.size(); ++index) { // Iterates over passengers in the elevator.
-                const auto& passenger = passengersInsideElevator[index];
-                // Displays passenger ID and destination floor with color coding.
-                cout << "\033[35m" << passenger.first << "t" << passenger.second << "\033[0m";
-                if (index < passengersInsideElevator.size() - 1) {
-                    cout << ", "; // Comma between passengers for readability.
-                }
-            }
-            cout << "] ";
-        }
-        else {
-            // Fills the line for floors without the elevator for alignment.
-            cout << "                                     ";
-        }
+ProfiledMutex coutMutex("cout"); // Mutex for synchronizing access to console output
 
-        // Delivered passengers
-        auto& delivered = deliveredPassengers[i];
-        for (auto& passenger : delivered) { // Iterates over delivered passengers at the current floor.
-            // Displays delivered passenger ID and destination floor with color coding.
-            cout << "\033[32m" << passenger.first << "t" << passenger.second << "\033[0m ";
-        }
+// Data structures for tracking passengers -- lock-free, see FloorQueues.h
+deque<PassengerEntry> passengerEntries; // Storage for every passenger's entry, filled by main() before the passenger starts
+PickupQueue pickupRequests[TOTAL_LEVELS]; // Pickup requests per floor; entries still Waiting are the passengers waiting there
+DestinationBucket passengersInsideElevator[TOTAL_LEVELS]; // Boarded passengers per destination floor; entries still Riding are in the car
+DeliveredList deliveredPassengers[TOTAL_LEVELS]; // Passengers who have left the elevator at each floor, kept for the display
+
+ProfiledSemaphore<MAX_CAPACITY> elevatorCapacity("elevator capacity", MAX_CAPACITY);
 
-        // Waiting passengers
-        auto& waiting = pickupRequests[i];
-        for (auto& passenger : waiting) { // Iterates over waiting passengers at the current floor.
-            // Displays waiting passenger ID and destination floor with color coding.
-            cout << "  \033[31m" << passenger.first << "t" << passenger.second << "\033[0m ";
+// Arrival notification -- how waiting passengers find out the elevator has reached their floor
+enum class WakeupMode { Polling, Event };
+std::atomic<WakeupMode> wakeupMode(WakeupMode::Event); // Polling sleeps and re-checks; Event blocks until elevator() signals the floor
+std::atomic<unsigned int> floorArrivals[TOTAL_LEVELS]; // Per-floor arrival counter, bumped and notified by elevator() on each arrival
+std::atomic<long long> floorArrivalTime[TOTAL_LEVELS]; // Time (ns since steady_clock epoch) of the most recent arrival at each floor
+std::atomic<bool> elevatorRunning(true); // Cleared to stop the elevator loop (used by the benchmark)
+
+// Returns the current time in nanoseconds, used to timestamp elevator arrivals.
+long long nowNanoseconds() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Blocks the calling passenger until the elevator is at the given floor.
+// Returns the number of times the passenger woke up to check the elevator's position.
+int waitForElevator(int floor) {
+    int wakeups = 0;
+    if (wakeupMode == WakeupMode::Polling) {
+        while (currentLevel != floor) {
+            this_thread::sleep_for(chrono::milliseconds(POLL_INTERVAL)); // Sleeps to reduce CPU usage while waiting.
+            wakeups++;
         }
+        return wakeups;
+    }
 
-        cout << endl; // New line for the next floor.
+    // The arrival counter is read before the position so an arrival between the two reads is never missed:
+    // elevator() moves first and bumps the counter second, so wait() returns at once if the counter has changed.
+    unsigned int arrivals = floorArrivals[floor].load();
+    while (currentLevel != floor) {
+        floorArrivals[floor].wait(arrivals); // Sleeps until elevator() signals an arrival at this floor only.
+        wakeups++;
+        arrivals = floorArrivals[floor].load();
     }
-    cout << "\n---------------------------------------\n"; 
+    return wakeups;
 }
 
 // Passenger class definition
@@ -98,90 +85,257 @@ public:
     int id; // Unique identifier for the passenger.
     int startFloor; // Floor where the passenger will board the elevator.
     int destinationFloor; // Passenger's destination floor.
+    PassengerEntry* entry; // The passenger's entry in the floor queues, owned by passengerEntries.
 
-    // Constructor to initialize a passenger with an ID, start floor, and destination floor.
-    Passenger(int id, int start, int destination) : id(id), startFloor(start), destinationFloor(destination) {}
+    // Constructor to initialize a passenger from its entry, which holds the ID, start floor, and destination floor.
+    explicit Passenger(PassengerEntry& entry) : id(entry.id), startFloor(entry.startFloor), destinationFloor(entry.destinationFloor), entry(&entry) {}
 
     // Function operator to simulate passenger behavior.
     void operator()() {
+        entry->requestTime = nowNanoseconds();
         {
-            lock_guard<mutex> lockP(pickupRequestsMutex); // Protects addition of pickup request.
-            pickupRequests[startFloor].push_back(pair(id, destinationFloor)); // Adds pickup request for this passenger.
+            BuildingChange change; // Shown as waiting from here on (see BuildingSnapshot).
+            pickupRequests[startFloor].push(*entry); // Adds pickup request for this passenger.
         }
         // Wait for the elevator to arrive at the start floor.
-        while (currentLevel != startFloor) {
-            this_thread::sleep_for(chrono::milliseconds(100)); // Sleeps to reduce CPU usage while waiting.
-        }
+        waitForElevator(startFloor);
         // Waits until there's space in the elevator, simulating boarding. Todo Task2
+        long long blockedSince = nowNanoseconds();
         elevatorCapacity.acquire();
+        entry->boardTime = nowNanoseconds();
+        passengerMetrics.record(Metric::CapacityBlock, startFloor, entry->boardTime - blockedSince);
+        passengerMetrics.record(Metric::Wait, startFloor, entry->boardTime - entry->requestTime);
+        // Boarding files the entry under its destination, then marks it, which also takes it out of the pickup queue.
+        // Both steps form one change, so a snapshot of the building sees the passenger either waiting or riding.
         {
-            // Locks for dealing with pickup and inside-elevator passenger lists without causing deadlocks.
-            std::unique_lock<std::mutex> lk1(pickupRequestsMutex, std::defer_lock);
-            std::unique_lock<std::mutex> lk2(passengersInsideElevatorMutex, std::defer_lock);
-            std::lock(lk1, lk2); // Locks both mutexes at once to prevent deadlock.
-
-            // Finds this passenger in the pickupRequests to remove them, indicating they're now inside the elevator.
-            auto itp = std::find_if(pickupRequests[startFloor].begin(), pickupRequests[startFloor].end(), [&](const auto& p) { return p.first == id; });
-            if (itp != pickupRequests[startFloor].end()) {
-                pickupRequests[startFloor].erase(itp);
-                passengersInsideElevator.emplace_back(id, destinationFloor);
-            }
-        } // automatically release mutexes
-        
+            BuildingChange change;
+            passengersInsideElevator[destinationFloor].push(*entry);
+            entry->state = PassengerEntry::Riding;
+        }
 
         passengersInElevator++; // Increments the passenger count in the elevator.
 
-        printBuilding(); // Updates the building display to reflect the new state.
-        
+        requestRedraw(); // Updates the building display to reflect the new state.
+
         // Waits for the elevator to reach the destination floor.
-        while (currentLevel != destinationFloor) {
-            this_thread::sleep_for(chrono::milliseconds(100)); // Sleeps to reduce CPU usage while waiting.
-        }
+        waitForElevator(destinationFloor);
 
-        // Exiting the elevator
+        // Exiting the elevator: the entry joins the floor's delivered list, then the state takes it out of the car.
         {
-            std::unique_lock<std::mutex> lk1(passengersInsideElevatorMutex);
-            std::unique_lock<std::mutex> lk2(deliveredPassengersMutex);
-            auto it = std::find_if(passengersInsideElevator.begin(), passengersInsideElevator.end(), [&](const auto& p) { return p.first == id; });
-            if (it != passengersInsideElevator.end()) {
-                passengersInsideElevator.erase(it);
-                deliveredPassengers[destinationFloor].emplace_back(id, destinationFloor);
-            }
-        } // Mutexes automatically unlock here
+            BuildingChange change;
+            deliveredPassengers[destinationFloor].push(*entry);
+            entry->state = PassengerEntry::Delivered;
+        }
+        entry->exitTime = nowNanoseconds();
+        passengerMetrics.record(Metric::Ride, destinationFloor, entry->exitTime - entry->boardTime);
 
         passengersInElevator--; // Safe to decrement after safely exiting
         elevatorCapacity.release(); // Signal space availability
-        printBuilding(); // Reflect final state changes
-    
-        {
-            lock_guard<mutex> lock(elevatorMutex); // Protects elevator state changes.
-            printBuilding(); // Updates the building display.
-            cout << "Passenger " << id << " exited at floor " << destinationFloor << endl;
-        }
+        logEvent("Passenger " + to_string(id) + " exited at floor " + to_string(destinationFloor));
+        requestRedraw(); // Reflect final state changes
     }
 };
 
 // The elevator function simulates the movement of the elevator through the building.
-void elevator() {
-    while (true) { // Infinite loop to keep the elevator moving.
-        this_thread::sleep_for(chrono::milliseconds(MOVE_DURATION)); // Waits for MOVE_DURATION, simulating floor-to-floor movement.
-        currentLevel += movingUp ? 1 : -1; // Moves the elevator up or down based on the direction.
-        if (currentLevel == 0 || currentLevel == TOTAL_LEVELS - 1) movingUp = !movingUp; // Reverses direction at the top or bottom floor.
-
+void elevator(int moveDuration) {
+    while (elevatorRunning) { // Keeps the elevator moving until it is told to stop.
+        this_thread::sleep_for(chrono::milliseconds(moveDuration)); // Waits for moveDuration, simulating floor-to-floor movement.
+        int level;
         {
-            lock_guard<mutex> lock(elevatorMutex); // Protects elevator state changes.
-            printBuilding(); // Updates the building display after each move.
+            BuildingChange change; // Floor and direction change together for the display.
+            level = currentLevel += movingUp ? 1 : -1; // Moves the elevator up or down based on the direction.
+            if (level == 0 || level == TOTAL_LEVELS - 1) movingUp = !movingUp; // Reverses direction at the top or bottom floor.
         }
+
+        // Signals the arrival so that only the passengers waiting on this floor wake up.
+        floorArrivalTime[level] = nowNanoseconds();
+        floorArrivals[level]++;
+        floorArrivals[level].notify_all();
+
+        // The elevator is the one thread that removes entries from the queues: while it stops at a floor, it drops the
+        // requests of the passengers who boarded there and the riders who got off there since its last stop.
+        pickupRequests[level].removeIf([](const PassengerEntry& e) { return e.state != PassengerEntry::Waiting; });
+        passengersInsideElevator[level].removeIf([](const PassengerEntry& e) { return e.state == PassengerEntry::Delivered; });
+
+        requestRedraw(); // Updates the building display after each move.
+    }
+}
+
+
+// Benchmark comparing the polling and event-driven wakeups.
+// Each waiter thread waits for the elevator at a random floor a number of times, without boarding, so that the
+// measurement isolates the cost of waiting: process CPU time while idle, wakeups, and the delay between the elevator
+// arriving at a floor and a waiting passenger noticing it.
+void benchmarkWakeups(WakeupMode mode, int waiters, int moveDuration, int arrivalsPerWaiter) {
+    wakeupMode = mode;
+    elevatorRunning = true;
+
+    std::atomic<long long> totalWakeups(0), totalLatency(0), maxLatency(0), latencySamples(0);
+    std::mt19937 rng(42); // Fixed seed so both modes see the same floors.
+    std::uniform_int_distribution<int> uni(0, TOTAL_LEVELS - 1);
+
+    auto wallStart = chrono::steady_clock::now();
+    clock_t cpuStart = clock();
+
+    thread elevatorThread(elevator, moveDuration);
+    vector<thread> threads;
+    for (int i = 0; i < waiters; i++) {
+        int floor = uni(rng);
+        threads.emplace_back([&, floor]() {
+            for (int n = 0; n < arrivalsPerWaiter; n++) {
+                int wakeups = waitForElevator(floor);
+                totalWakeups += wakeups;
+                if (wakeups > 0) { // Latency is only meaningful if the passenger was actually waiting for the arrival.
+                    long long latency = nowNanoseconds() - floorArrivalTime[floor];
+                    totalLatency += latency;
+                    latencySamples++;
+                    long long seen = maxLatency;
+                    while (latency > seen && !maxLatency.compare_exchange_weak(seen, latency)) {}
+                }
+                // Stays on board for one move so that the next iteration measures a fresh arrival.
+                this_thread::sleep_for(chrono::milliseconds(moveDuration));
+            }
+        });
     }
+    for (auto& t : threads) t.join();
+
+    clock_t cpuEnd = clock();
+    double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
+    elevatorRunning = false;
+    elevatorThread.join();
+
+    double cpuSeconds = static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+    cout << (mode == WakeupMode::Polling ? "Polling" : "Event  ")
+        << " | waiters: " << waiters
+        << " | wall: " << wallSeconds << " s"
+        << " | CPU: " << cpuSeconds << " s (" << 100.0 * cpuSeconds / wallSeconds << "% of one core)"
+        << " | wakeups: " << totalWakeups.load()
+        << " | board latency avg: " << totalLatency / max(1LL, latencySamples.load()) / 1000 << " us"
+        << ", max: " << maxLatency / 1000 << " us" << endl;
 }
 
+int main(int argc, char* argv[]) {
+    LockReportOnExit lockReport(cout); // Lock contention of whichever mode runs, when built with LOCK_PROFILING (lock_profiler.h)
+
+    // Run "Elevator --bench-wakeups [waiters]" to compare polling and event-driven passenger wakeups.
+    if (argc > 1 && string(argv[1]) == "--bench-wakeups") {
+        int waiters = argc > 2 ? atoi(argv[2]) : 1000;
+        benchmarkWakeups(WakeupMode::Polling, waiters, 250, 3);
+        benchmarkWakeups(WakeupMode::Event, waiters, 250, 3);
+        return 0;
+    }
+    // Run "Elevator --bench-queues [threads] [passengers per thread]" to measure the request queues under lobby contention.
+    if (argc > 1 && string(argv[1]) == "--bench-queues") {
+        int threads = argc > 2 ? atoi(argv[2]) : max(1u, thread::hardware_concurrency());
+        int passengers = argc > 3 ? atoi(argv[3]) : 20000;
+        benchmarkFloorQueues(threads, passengers);
+        return 0;
+    }
+    // Run "Elevator --coroutines [passengers] [workers]" to simulate passengers as coroutines on a worker pool.
+    if (argc > 1 && string(argv[1]) == "--coroutines") {
+        long long passengers = argc > 2 ? atoll(argv[2]) : 1000000;
+        int workers = argc > 3 ? atoi(argv[3]) : static_cast<int>(max(1u, thread::hardware_concurrency()));
+        if (workers < 1) {
+            cerr << "The coroutines need at least 1 worker thread" << endl;
+            return 1;
+        }
+        runCoroutineSimulation(passengers, workers);
+        return 0;
+    }
+    // Run "Elevator --simulate [passengers] [seed]" to run the simulation on a virtual clock, without real sleeps.
+    if (argc > 1 && string(argv[1]) == "--simulate") {
+        int passengers = argc > 2 ? atoi(argv[2]) : 10;
+        unsigned int seed = argc > 3 ? atoi(argv[3]) : random_device()();
+        runEventSimulation(passengers, seed);
+        return 0;
+    }
+    // Run "Elevator --bench-simulation [scenarios] [passengers]" to measure the speed of the virtual-clock simulation.
+    if (argc > 1 && string(argv[1]) == "--bench-simulation") {
+        int scenarios = argc > 2 ? atoi(argv[2]) : 1000;
+        int passengers = argc > 3 ? atoi(argv[3]) : 1000;
+        benchmarkEventSimulation(scenarios, passengers);
+        return 0;
+    }
+    // Run "Elevator --compare-dispatch [floors] [cars] [passengers] [seed]" to compare the dispatch policies on one load.
+    if (argc > 1 && string(argv[1]) == "--compare-dispatch") {
+        SimulationConfig config;
+        config.levels = argc > 2 ? atoi(argv[2]) : TOTAL_LEVELS;
+        config.cars = argc > 3 ? atoi(argv[3]) : 4;
+        int passengers = argc > 4 ? atoi(argv[4]) : 2000;
+        unsigned int seed = argc > 5 ? atoi(argv[5]) : 42;
+        if (!checkConfig(config)) return 1;
+        compareDispatchers(config, passengers, 60LL * 60 * 1000, seed); // One simulated hour of traffic.
+        return 0;
+    }
+    // Run "Elevator --bench-workloads [arrivals/hour] [hours] [cars] [dispatcher] [seed]" to report throughput and
+    // latency of every traffic pattern.
+    if (argc > 1 && string(argv[1]) == "--bench-workloads") {
+        SimulationConfig config;
+        double arrivalsPerHour = argc > 2 ? atof(argv[2]) : 300;
+        double hours = argc > 3 ? atof(argv[3]) : 1;
+        config.cars = argc > 4 ? atoi(argv[4]) : 1;
+        string dispatcher = argc > 5 ? argv[5] : "look";
+        uint64_t seed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 42;
+        if (!makeDispatcher(dispatcher)) {
+            cerr << "Unknown dispatcher " << dispatcher << endl;
+            return 1;
+        }
+        if (!checkConfig(config) || !checkWorkload(arrivalsPerHour, hours)) return 1;
+        benchmarkWorkloads(config, dispatcher, arrivalsPerHour, hours, seed);
+        return 0;
+    }
+    // Run "Elevator --sweep [--levels 10,20] [--capacity 3,8] [--cars 1,2] [--move ms,...] [--stop ms,...]
+    // [--dispatch look,destination] [--pattern P] [--rate N] [--hours H] [--seeds N] [--threads N] [--out FILE]"
+    // to simulate every combination with many seeds on all cores and print the aggregated statistics as CSV.
+    if (argc > 1 && string(argv[1]) == "--sweep") {
+        return sweepMain(argc, argv);
+    }
+    // Run "Elevator --generate-trace FILE [pattern] [arrivals/hour] [hours] [seed]" to record a generated workload.
+    if (argc > 2 && string(argv[1]) == "--generate-trace") {
+        WorkloadConfig workload;
+        if (argc > 3 && !parsePattern(argv[3], workload.pattern)) {
+            cerr << "Unknown pattern " << argv[3] << " (uniform, up-peak, lunch or down-peak)" << endl;
+            return 1;
+        }
+        workload.arrivalsPerHour = argc > 4 ? atof(argv[4]) : 300;
+        double hours = argc > 5 ? atof(argv[5]) : 1;
+        if (!checkWorkload(workload.arrivalsPerHour, hours)) return 1;
+        workload.duration = static_cast<SimTime>(hours * 3600 * 1000);
+        workload.seed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 42;
+        return saveTrace(argv[2], generateWorkload(workload)) ? 0 : 1;
+    }
+    // Run "Elevator --replay-trace FILE [cars] [dispatcher]" to run a recorded workload.
+    if (argc > 2 && string(argv[1]) == "--replay-trace") {
+        SimulationConfig config;
+        config.cars = argc > 3 ? atoi(argv[3]) : 1;
+        string dispatcher = argc > 4 ? argv[4] : "look";
+        if (!makeDispatcher(dispatcher)) {
+            cerr << "Unknown dispatcher " << dispatcher << endl;
+            return 1;
+        }
+        if (!checkConfig(config)) return 1;
+        return replayTrace(argv[2], config, dispatcher) ? 0 : 1;
+    }
+
+    // Display options: "--headless" draws nothing, "--fps N" redraws the building at most N times a second.
+    // "--metrics FILE" writes the latency histograms to FILE at the end (JSON if it ends in .json, CSV otherwise).
+    // "--seed N" makes the passengers' floors reproducible.
+    bool headless = false;
+    int framesPerSecond = 10;
+    string metricsFile;
+    unsigned int seed = random_device()(); // Non-deterministic unless a seed is given.
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--headless") headless = true;
+        else if (string(argv[i]) == "--seed" && i + 1 < argc) seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        else if (string(argv[i]) == "--fps" && i + 1 < argc) framesPerSecond = atoi(argv[++i]);
+        else if (string(argv[i]) == "--metrics" && i + 1 < argc) metricsFile = argv[++i];
+    }
+    Renderer renderer(framesPerSecond, headless); // Draws the building on its own thread until the passengers are done.
 
-int main() {
     vector<thread> threads; // Stores threads for each passenger.
-    thread elevatorThread(elevator); // Thread for the elevator's continuous operation.
+    thread elevatorThread(elevator, MOVE_DURATION); // Thread for the elevator's continuous operation.
 
-    std::random_device rd; // Non-deterministic random number generator.
-    std::mt19937 rng(rd()); // Random number generator using Mersenne Twister algorithm.
+    std::mt19937 rng(seed); // Random number generator using Mersenne Twister algorithm.
     std::uniform_int_distribution<int> uni(0, TOTAL_LEVELS - 1); // Distribution for floor numbers.
 
     // Creates passenger threads with random start and destination floors.
@@ -192,7 +346,8 @@ int main() {
             destinationFloor = uni(rng); // Ensures destination floor is different from start floor.
         } while (destinationFloor == startFloor);
 
-        threads.emplace_back(Passenger(i, startFloor, destinationFloor)); // Adds a new passenger thread.
+        passengerEntries.emplace_back(i, startFloor, destinationFloor); // Must exist for as long as the display may read it.
+        threads.emplace_back(Passenger(passengerEntries.back())); // Adds a new passenger thread.
     }
 
     for (auto& t : threads) { // Joins all passenger threads to the main thread to ensure completion.
@@ -201,7 +356,15 @@ int main() {
         }
     }
 
-    elevatorThread.detach(); // Allows the elevator thread to run independently of the main thread.
+    elevatorRunning = false; // The elevator reads the passenger entries, so it must stop before they are destroyed.
+    elevatorThread.join();
+    renderer.stop(); // Final frame, so that the summary is printed below it.
+
+    passengerMetrics.printSummary();
+    if (!metricsFile.empty() && !passengerMetrics.exportFile(metricsFile)) {
+        cerr << "Could not write metrics to " << metricsFile << endl;
+        return 1;
+    }
 
     return 0; 
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+// CMP202
+// Elevator System Simulation
+// Shared constants and state of the elevator simulation, defined in Elevator.cpp
+
+#ifndef ELEVATOR_H
+#define ELEVATOR_H
+
+#include <atomic>
+#include <mutex>
+#include <semaphore>
+
+#include "../common/lock_profiler.h"
+#include "FloorQueues.h"
+
+// Constants to define the elevator system's properties
+constexpr int TOTAL_LEVELS = 10; // Total number of floors in the building
+constexpr int MAX_CAPACITY = 3; // Maximum number of passengers the elevator can hold
+constexpr int MOVE_DURATION = 2000; // Time in milliseconds it takes the elevator to move between floors
+constexpr int STOP_DURATION = 500; // Time in milliseconds a car stands at a floor in the event simulation (the threaded elevator does not stop)
+constexpr int POLL_INTERVAL = 100; // Time in milliseconds a polling passenger sleeps between checks of the elevator's position
+
+// The threaded simulation runs one car, so its state stays global. Several cars sharing the pickup requests, with
+// pluggable dispatch policies, are modelled only by the discrete-event simulation (Elevator in Dispatch.h).
+extern std::atomic<int> currentLevel; // Current floor of the elevator
+extern std::atomic<bool> movingUp; // Direction of elevator movement
+extern std::atomic<int> passengersInElevator; // Number of passengers currently in the elevator
+extern ProfiledSemaphore<MAX_CAPACITY> elevatorCapacity; // Limits the number of passengers in the elevator
+extern ProfiledMutex coutMutex; // Mutex for synchronizing access to console output
+extern PickupQueue pickupRequests[TOTAL_LEVELS]; // Pickup requests per floor
+extern DestinationBucket passengersInsideElevator[TOTAL_LEVELS]; // Boarded passengers per destination floor
+extern DeliveredList deliveredPassengers[TOTAL_LEVELS]; // Passengers who have left the elevator, per floor
+
+#endif
@@ -0,0 +1,246 @@
+// CMP202
+// Elevator System Simulation
+// Discrete-event simulation -- the same elevator and passengers driven by a virtual clock instead of real sleeps
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "EventSimulation.h"
+using namespace std;
+
+EventSimulation::EventSimulation(const SimulationConfig& config, unique_ptr<Dispatcher> dispatcher)
+    : settings(config), dispatcher(dispatcher ? move(dispatcher) : make_unique<SweepDispatcher>()),
+    waiting(config.levels), openCalls(config.levels) {
+    for (int i = 0; i < config.cars; i++) {
+        elevators.emplace_back(i, config.levels);
+    }
+}
+
+int EventSimulation::addPassenger(int startFloor, int destinationFloor, SimTime requestTime) {
+    int id = static_cast<int>(people.size());
+    people.push_back(SimPassenger{ id, startFloor, destinationFloor, requestTime });
+    schedule(requestTime, SimEvent::Type::PassengerRequest, id);
+    return id;
+}
+
+void EventSimulation::schedule(SimTime time, SimEvent::Type type, int subject, int car) {
+    events.push(SimEvent{ time, nextSequence++, type, subject, car });
+}
+
+int EventSimulation::letPassengersOff(Elevator& car) {
+    int floor = car.level;
+    if (car.riderStops[floor] == 0) return 0;
+
+    auto arrived = [&](int p) { return people[p].destinationFloor == floor; };
+    for (int p : car.riders) {
+        if (arrived(p)) {
+            people[p].exitTime = clock;
+            delivered++;
+            if (verbose) cout << "[" << clock << " ms] Passenger " << p << " exited car " << car.id << " at floor " << floor << endl;
+        }
+    }
+    car.riders.erase(remove_if(car.riders.begin(), car.riders.end(), arrived), car.riders.end());
+    int count = car.riderStops[floor];
+    car.riderStops[floor] = 0;
+    return count;
+}
+
+int EventSimulation::letPassengersOn(Elevator& car) {
+    int floor = car.level;
+    if (openCalls[floor] == 0 && car.assignedCalls[floor] == 0) return 0;
+
+    int count = 0;
+    auto& queue = waiting[floor];
+    for (auto it = queue.begin(); it != queue.end() && static_cast<int>(car.riders.size()) < settings.capacity;) {
+        SimPassenger& p = people[*it];
+        if (p.assignedCar != -1 && p.assignedCar != car.id) { // Waiting for a different car.
+            ++it;
+            continue;
+        }
+        if (p.assignedCar == -1) {
+            openCalls[floor]--;
+        }
+        else {
+            car.assignedCalls[floor]--;
+            car.assignedDestinations[p.destinationFloor]--;
+            car.assignedTotal--;
+        }
+        p.boardTime = clock;
+        car.riders.push_back(p.id);
+        car.riderStops[p.destinationFloor]++;
+        count++;
+        if (verbose) cout << "[" << clock << " ms] Passenger " << p.id << " boarded car " << car.id << " at floor " << floor << endl;
+        it = queue.erase(it);
+    }
+    return count;
+}
+
+void EventSimulation::wake(Elevator& car) {
+    if (!car.idle) return;
+    car.idle = false;
+    schedule(clock, SimEvent::Type::ElevatorArrival, car.level, car.id);
+}
+
+void EventSimulation::run() {
+    // The cars start standing at the ground floor, after any passengers that are already there.
+    for (auto& car : elevators) {
+        schedule(clock, SimEvent::Type::ElevatorArrival, car.level, car.id);
+    }
+
+    while (delivered < static_cast<long long>(people.size()) && !events.empty()) {
+        SimEvent event = events.top();
+        events.pop();
+        clock = event.time;
+
+        switch (event.type) {
+        case SimEvent::Type::PassengerRequest: {
+            SimPassenger& p = people[event.subject];
+            waiting[p.startFloor].push_back(p.id);
+            p.assignedCar = dispatcher->assign(*this, p);
+            if (p.assignedCar == -1) {
+                openCalls[p.startFloor]++;
+                for (auto& car : elevators) wake(car);
+            }
+            else {
+                Elevator& car = elevators[p.assignedCar];
+                car.assignedCalls[p.startFloor]++;
+                car.assignedDestinations[p.destinationFloor]++;
+                car.assignedTotal++;
+                wake(car);
+            }
+            break;
+        }
+
+        case SimEvent::Type::ElevatorArrival: {
+            // The car only stops (and spends stopDuration) if somebody gets off or on.
+            Elevator& car = elevators[event.car];
+            int moved = letPassengersOff(car) + letPassengersOn(car);
+            schedule(clock + (moved > 0 ? settings.stopDuration : 0), SimEvent::Type::ElevatorDeparture, car.level, car.id);
+            break;
+        }
+
+        case SimEvent::Type::ElevatorDeparture: {
+            Elevator& car = elevators[event.car];
+            letPassengersOn(car); // Passengers that arrived while the doors were open.
+            int move = dispatcher->nextMove(*this, car);
+            if (move == 0) {
+                car.idle = true; // Nothing to do until the next request.
+                break;
+            }
+            car.movingUp = move > 0;
+            car.level += move;
+            schedule(clock + settings.moveDuration, SimEvent::Type::ElevatorArrival, car.level, car.id);
+            break;
+        }
+        }
+    }
+}
+
+// Returns the given percentile (0-100) of the values, which are reordered.
+static double percentile(vector<SimTime>& values, double p) {
+    if (values.empty()) return 0;
+    size_t index = min(values.size() - 1, static_cast<size_t>(p / 100.0 * values.size()));
+    nth_element(values.begin(), values.begin() + index, values.end());
+    return static_cast<double>(values[index]);
+}
+
+SimulationStats EventSimulation::stats() const {
+    SimulationStats s;
+    vector<SimTime> waits, journeys;
+    double totalWait = 0, totalRide = 0;
+    for (const auto& p : people) {
+        if (p.exitTime < 0) continue;
+        s.delivered++;
+        waits.push_back(p.boardTime - p.requestTime);
+        journeys.push_back(p.exitTime - p.requestTime);
+        totalWait += static_cast<double>(p.boardTime - p.requestTime);
+        totalRide += static_cast<double>(p.exitTime - p.boardTime);
+        s.simulatedTime = max(s.simulatedTime, p.exitTime);
+    }
+    if (s.delivered > 0) {
+        s.averageWait = totalWait / s.delivered;
+        s.averageRide = totalRide / s.delivered;
+        s.averageJourney = (totalWait + totalRide) / s.delivered;
+    }
+    s.p99Wait = percentile(waits, 99);
+    s.p99Journey = percentile(journeys, 99);
+    return s;
+}
+
+// Adds passengers with random start and destination floors, requesting at random times within the given period.
+static void addRandomPassengers(EventSimulation& sim, int passengers, SimTime period, mt19937& rng) {
+    uniform_int_distribution<int> uni(0, sim.config().levels - 1); // Distribution for floor numbers.
+    uniform_int_distribution<SimTime> when(0, period);
+    for (int i = 0; i < passengers; i++) {
+        int startFloor = uni(rng);
+        int destinationFloor;
+        do {
+            destinationFloor = uni(rng); // Ensures destination floor is different from start floor.
+        } while (destinationFloor == startFloor);
+        sim.addPassenger(startFloor, destinationFloor, period > 0 ? when(rng) : 0);
+    }
+}
+
+bool checkConfig(const SimulationConfig& config) {
+    if (config.levels < 2) cerr << "A building needs at least 2 floors" << endl;
+    else if (config.cars < 1) cerr << "A building needs at least 1 car" << endl;
+    else if (config.capacity < 1) cerr << "A car must hold at least 1 passenger" << endl;
+    else if (config.moveDuration < 1) cerr << "Moving between floors must take at least 1 ms" << endl;
+    else if (config.stopDuration < 0) cerr << "A stop cannot take less than 0 ms" << endl;
+    else return true;
+    return false;
+}
+
+void runEventSimulation(int passengers, unsigned int seed) {
+    EventSimulation sim;
+    sim.verbose = true;
+    mt19937 rng(seed);
+    addRandomPassengers(sim, passengers, 0, rng); // Everybody requests at once, like the threads started by main().
+    sim.run();
+
+    SimulationStats s = sim.stats();
+    cout << "Delivered " << s.delivered << " passengers in " << s.simulatedTime / 1000.0 << " simulated seconds"
+        << " | average wait: " << s.averageWait / 1000.0 << " s | average ride: " << s.averageRide / 1000.0 << " s" << endl;
+}
+
+void benchmarkEventSimulation(int scenarios, int passengersPerScenario) {
+    constexpr SimTime DAY = 24LL * 60 * 60 * 1000;
+    mt19937 rng(42); // Fixed seed so runs can be compared.
+
+    double simulatedSeconds = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < scenarios; i++) {
+        EventSimulation sim;
+        addRandomPassengers(sim, passengersPerScenario, DAY, rng); // Requests spread over one simulated day.
+        sim.run();
+        simulatedSeconds += sim.stats().simulatedTime / 1000.0;
+    }
+    double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << scenarios << " scenarios of " << passengersPerScenario << " passengers in " << wallSeconds << " s"
+        << " | " << scenarios / wallSeconds * 60 << " scenarios per minute"
+        << " | " << simulatedSeconds / wallSeconds << " simulated seconds per wall-clock second" << endl;
+}
+
+void compareDispatchers(const SimulationConfig& config, int passengers, SimTime period, unsigned int seed) {
+    cout << config.levels << " floors, " << config.cars << " cars of " << config.capacity << ", "
+        << passengers << " passengers over " << period / 1000 << " s (seed " << seed << ")" << endl;
+    cout << left << setw(14) << "policy" << right << setw(10) << "delivered" << setw(12) << "avg wait" << setw(12) << "p99 wait"
+        << setw(14) << "avg journey" << setw(14) << "p99 journey" << endl;
+
+    for (const string& name : dispatcherNames()) {
+        EventSimulation sim(config, makeDispatcher(name));
+        mt19937 rng(seed); // Same seed for every policy, so they all see the same load.
+        addRandomPassengers(sim, passengers, period, rng);
+        sim.run();
+
+        SimulationStats s = sim.stats();
+        cout << left << setw(14) << name << right << setw(10) << s.delivered << fixed << setprecision(1)
+            << setw(11) << s.averageWait / 1000.0 << "s" << setw(11) << s.p99Wait / 1000.0 << "s"
+            << setw(13) << s.averageJourney / 1000.0 << "s" << setw(13) << s.p99Journey / 1000.0 << "s" << endl;
+        cout.unsetf(ios::fixed);
+    }
+}
@@ -0,0 +1,121 @@
+// CMP202
+// Elevator System Simulation
+// Discrete-event simulation -- the same elevator and passengers driven by a virtual clock instead of real sleeps
+
+#ifndef EVENT_SIMULATION_H
+#define EVENT_SIMULATION_H
+
+#include <deque>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "Dispatch.h"
+#include "Elevator.h"
+
+// Virtual time in milliseconds, the unit of MOVE_DURATION and STOP_DURATION.
+using SimTime = long long;
+
+// Properties of the simulated building. The defaults are the constants used by the threaded simulation.
+struct SimulationConfig {
+    int levels = TOTAL_LEVELS; // Total number of floors in the building
+    int capacity = MAX_CAPACITY; // Maximum number of passengers the elevator can hold
+    SimTime moveDuration = MOVE_DURATION; // Time it takes the elevator to move between floors
+    SimTime stopDuration = STOP_DURATION; // Time the elevator stands at a floor when passengers get on or off
+    int cars = 1; // Number of elevator cars sharing the building's pickup requests
+};
+
+// A passenger of the discrete-event simulation, with the times at which it requested, boarded and left the elevator.
+struct SimPassenger {
+    int id;
+    int startFloor;
+    int destinationFloor;
+    SimTime requestTime;
+    int assignedCar = -1; // Car chosen by the dispatcher, or -1 if any car may pick the passenger up
+    SimTime boardTime = -1; // -1 until the passenger has boarded
+    SimTime exitTime = -1; // -1 until the passenger has been delivered
+};
+
+// Something that happens at a point of virtual time.
+struct SimEvent {
+    enum class Type { PassengerRequest, ElevatorArrival, ElevatorDeparture };
+
+    SimTime time;
+    long long sequence; // Breaks ties between events at the same time in the order they were scheduled
+    Type type;
+    int subject; // Passenger index for PassengerRequest, floor for the elevator events
+    int car; // Car for the elevator events
+
+    bool operator>(const SimEvent& other) const {
+        return time != other.time ? time > other.time : sequence > other.sequence;
+    }
+};
+
+// Summary of a finished simulation.
+struct SimulationStats {
+    long long delivered = 0; // Passengers that reached their destination
+    double averageWait = 0; // Average time from request to boarding, in milliseconds
+    double averageRide = 0; // Average time from boarding to exit, in milliseconds
+    double p99Wait = 0; // 99th percentile of the wait, in milliseconds
+    double averageJourney = 0; // Average time from request to exit (wait plus ride), in milliseconds
+    double p99Journey = 0; // 99th percentile of the journey, in milliseconds
+    SimTime simulatedTime = 0; // Virtual time at which the last passenger was delivered
+};
+
+// Runs the elevator of the threaded simulation on a virtual clock: passengers board at their start floor in the order
+// they arrived as long as there is room, and leave at their destination. The clock jumps straight from one event to
+// the next, so no real time passes. There can be several cars; the dispatcher decides which car serves each passenger
+// and where each car goes. The default dispatcher sweeps from the bottom to the top floor and back, like elevator().
+class EventSimulation {
+public:
+    explicit EventSimulation(const SimulationConfig& config = SimulationConfig(), std::unique_ptr<Dispatcher> dispatcher = nullptr);
+
+    // Adds a passenger that requests the elevator at the given virtual time. Returns the passenger's index.
+    int addPassenger(int startFloor, int destinationFloor, SimTime requestTime);
+
+    // Processes events until every added passenger has been delivered.
+    void run();
+
+    // When set, boarding and exits are printed as they happen.
+    bool verbose = false;
+
+    const std::vector<SimPassenger>& passengers() const { return people; }
+    const std::vector<Elevator>& cars() const { return elevators; }
+    const SimulationConfig& config() const { return settings; }
+    int openCallsAt(int floor) const { return openCalls[floor]; } // Waiting passengers not assigned to a car
+    SimulationStats stats() const;
+    SimTime now() const { return clock; }
+
+private:
+    void schedule(SimTime time, SimEvent::Type type, int subject, int car = 0);
+    int letPassengersOff(Elevator& car); // Returns the number of passengers that got off
+    int letPassengersOn(Elevator& car); // Returns the number of passengers that got on
+    void wake(Elevator& car); // Makes an idle car consider the pending requests again
+
+    SimulationConfig settings;
+    std::unique_ptr<Dispatcher> dispatcher;
+    std::vector<SimPassenger> people; // Every passenger, indexed by id
+    std::vector<std::deque<int>> waiting; // Pickup requests shared by all cars: passengers waiting at each floor, in arrival order
+    std::vector<int> openCalls; // Number of waiting passengers at each floor that any car may pick up
+    std::vector<Elevator> elevators; // The cars
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events; // Pending events, earliest first
+    long long nextSequence = 0;
+    SimTime clock = 0; // Current virtual time
+    long long delivered = 0;
+};
+
+// True if the configuration can be simulated: at least 2 floors, 1 car and a capacity of 1, moves of at least 1 ms and
+// stops of no negative length (the event clock must never run backwards). Otherwise prints why to cerr.
+bool checkConfig(const SimulationConfig& config);
+
+// Simulates passengers with random floors and prints what happens, like the threaded simulation does.
+void runEventSimulation(int passengers, unsigned int seed);
+
+// Runs many random scenarios and reports how much virtual time is simulated per second of real time.
+void benchmarkEventSimulation(int scenarios, int passengersPerScenario);
+
+// Runs every dispatch policy on the same random load and prints wait and journey times for each.
+void compareDispatchers(const SimulationConfig& config, int passengers, SimTime period, unsigned int seed);
+
+#endif
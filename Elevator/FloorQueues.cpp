@@ -0,0 +1,140 @@
+// CMP202
+// Elevator System Simulation
+// Per-floor passenger queues that passengers can join, board and leave without taking a lock
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Elevator.h"
+#include "FloorQueues.h"
+#include "Renderer.h"
+using namespace std;
+
+// The request table used before the lock-free queues: one map of vectors per role behind one mutex each.
+struct LockedRequestTable {
+    map<int, vector<pair<int, int>>> pickupRequests;
+    mutex pickupRequestsMutex;
+    vector<pair<int, int>> passengersInsideElevator;
+    mutex passengersInsideElevatorMutex;
+    map<int, vector<pair<int, int>>> deliveredPassengers;
+    mutex deliveredPassengersMutex;
+
+    void request(int id, int start, int destination) {
+        lock_guard<mutex> lock(pickupRequestsMutex);
+        pickupRequests[start].push_back(pair(id, destination));
+    }
+
+    void board(int id, int start, int destination) {
+        unique_lock<mutex> lk1(pickupRequestsMutex, defer_lock);
+        unique_lock<mutex> lk2(passengersInsideElevatorMutex, defer_lock);
+        lock(lk1, lk2);
+        auto itp = find_if(pickupRequests[start].begin(), pickupRequests[start].end(), [&](const auto& p) { return p.first == id; });
+        if (itp != pickupRequests[start].end()) {
+            pickupRequests[start].erase(itp);
+            passengersInsideElevator.emplace_back(id, destination);
+        }
+    }
+
+    void exit(int id, int destination) {
+        unique_lock<mutex> lk1(passengersInsideElevatorMutex);
+        unique_lock<mutex> lk2(deliveredPassengersMutex);
+        auto it = find_if(passengersInsideElevator.begin(), passengersInsideElevator.end(), [&](const auto& p) { return p.first == id; });
+        if (it != passengersInsideElevator.end()) {
+            passengersInsideElevator.erase(it);
+            deliveredPassengers[destination].emplace_back(id, destination);
+        }
+    }
+};
+
+// The lock-free queues as used in Elevator.cpp: passengers push first and publish their state second, inside a
+// BuildingChange for the display, and one thread (the elevator there) removes the served entries.
+struct LockFreeRequestTable {
+    PickupQueue pickupRequests[TOTAL_LEVELS];
+    DestinationBucket passengersInsideElevator[TOTAL_LEVELS];
+    DeliveredList deliveredPassengers[TOTAL_LEVELS];
+
+    void request(PassengerEntry& entry) {
+        BuildingChange change;
+        pickupRequests[entry.startFloor].push(entry);
+    }
+
+    void board(PassengerEntry& entry) {
+        BuildingChange change;
+        passengersInsideElevator[entry.destinationFloor].push(entry);
+        entry.state = PassengerEntry::Riding;
+    }
+
+    void exit(PassengerEntry& entry) {
+        BuildingChange change;
+        deliveredPassengers[entry.destinationFloor].push(entry);
+        entry.state = PassengerEntry::Delivered;
+    }
+
+    // What the elevator does when it stops at a floor
+    void removeServed(int floor) {
+        pickupRequests[floor].removeIf([](const PassengerEntry& e) { return e.state != PassengerEntry::Waiting; });
+        passengersInsideElevator[floor].removeIf([](const PassengerEntry& e) { return e.state == PassengerEntry::Delivered; });
+    }
+};
+
+// Runs body(thread index) on the given number of threads and returns the elapsed time in seconds.
+template <typename F>
+static double timeThreads(int threads, F body) {
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) workers.emplace_back(body, t);
+    for (auto& w : workers) w.join();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void benchmarkFloorQueues(int threads, int passengersPerThread) {
+    constexpr int LOBBY = 0;
+    constexpr int BATCH = 64; // Passengers each thread keeps waiting in the lobby at a time, as under heavy lobby load.
+    long long operations = 3LL * threads * passengersPerThread; // Request, board and exit for every passenger.
+
+    LockedRequestTable locked;
+    double lockedSeconds = timeThreads(threads, [&](int t) {
+        for (int base = 0; base < passengersPerThread; base += BATCH) {
+            int end = min(passengersPerThread, base + BATCH);
+            for (int i = base; i < end; i++) locked.request(t * passengersPerThread + i, LOBBY, 1 + i % (TOTAL_LEVELS - 1));
+            for (int i = base; i < end; i++) locked.board(t * passengersPerThread + i, LOBBY, 1 + i % (TOTAL_LEVELS - 1));
+            for (int i = base; i < end; i++) locked.exit(t * passengersPerThread + i, 1 + i % (TOTAL_LEVELS - 1));
+        }
+    });
+
+    LockFreeRequestTable lockFree;
+    deque<PassengerEntry> entries; // Entries must outlive the queues' use of them.
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < passengersPerThread; i++) entries.emplace_back(t * passengersPerThread + i, LOBBY, 1 + i % (TOTAL_LEVELS - 1));
+    }
+    // One more thread stands in for the elevator, visiting the floors in turn and removing the served entries.
+    atomic<bool> passengersDone(false);
+    thread consumer([&]() {
+        while (!passengersDone) {
+            for (int floor = 0; floor < TOTAL_LEVELS; floor++) lockFree.removeServed(floor);
+            this_thread::yield();
+        }
+    });
+    double lockFreeSeconds = timeThreads(threads, [&](int t) {
+        size_t first = static_cast<size_t>(t) * passengersPerThread;
+        for (int base = 0; base < passengersPerThread; base += BATCH) {
+            int end = min(passengersPerThread, base + BATCH);
+            for (int i = base; i < end; i++) lockFree.request(entries[first + i]);
+            for (int i = base; i < end; i++) lockFree.board(entries[first + i]);
+            for (int i = base; i < end; i++) lockFree.exit(entries[first + i]);
+        }
+    });
+    passengersDone = true;
+    consumer.join();
+
+    cout << threads << " threads x " << passengersPerThread << " passengers through floor " << LOBBY << endl;
+    cout << "map + vector + mutex: " << lockedSeconds << " s (" << operations / lockedSeconds / 1e6 << " M operations/s)" << endl;
+    cout << "lock-free queues:     " << lockFreeSeconds << " s (" << operations / lockFreeSeconds / 1e6 << " M operations/s)" << endl;
+}
@@ -0,0 +1,99 @@
+// CMP202
+// Elevator System Simulation
+// Per-floor passenger queues that passengers can join, board and leave without taking a lock
+
+#ifndef FLOOR_QUEUES_H
+#define FLOOR_QUEUES_H
+
+#include <atomic>
+
+// A passenger's entry in the queues. It is linked into the pickup queue of its start floor when it requests the
+// elevator, into the bucket of its destination floor when it boards, and into the delivered list of that floor once it
+// has left the car. Boarding and exiting only push and change the state, so they take O(1) time and never search;
+// the elevator unlinks the entries a floor no longer needs when it stops there (see removeIf()).
+struct PassengerEntry {
+    enum State { Waiting, Riding, Delivered };
+
+    PassengerEntry() = default;
+    PassengerEntry(int id, int start, int destination) : id(id), startFloor(start), destinationFloor(destination) {}
+
+    int id = -1;
+    int startFloor = 0;
+    int destinationFloor = 0;
+    long long requestTime = 0; // Timestamps in nanoseconds (see nowNanoseconds()), written only by the passenger's own thread
+    long long boardTime = 0;
+    long long exitTime = 0;
+    std::atomic<State> state{ Waiting };
+    std::atomic<PassengerEntry*> nextWaiting{ nullptr }; // Next entry in the pickup queue of startFloor
+    std::atomic<PassengerEntry*> nextInCar{ nullptr }; // Next entry in the bucket of destinationFloor
+    std::atomic<PassengerEntry*> nextDelivered{ nullptr }; // Next entry in the delivered list of destinationFloor
+};
+
+// A queue of entries, linked through the member Next, that any number of threads can push to and read at the same
+// time, and one thread at a time (the consumer) can remove entries from. Removed entries keep their own link, so a
+// reader standing on one still reaches the rest of the queue; the entries' storage is owned by the caller and must
+// outlive the queue, and an entry is pushed to a given queue at most once.
+template <std::atomic<PassengerEntry*> PassengerEntry::* Next>
+class PassengerQueue {
+public:
+    PassengerQueue() = default;
+    PassengerQueue(const PassengerQueue&) = delete;
+    PassengerQueue& operator=(const PassengerQueue&) = delete;
+
+    // Appends an entry. Wait-free: the tail is swapped first and the previous tail linked to the entry afterwards,
+    // so a reader may briefly not see the newest entry yet.
+    void push(PassengerEntry& entry) {
+        (entry.*Next).store(nullptr, std::memory_order_relaxed);
+        PassengerEntry* previous = tail.exchange(&entry, std::memory_order_acq_rel);
+        (previous->*Next).store(&entry, std::memory_order_release);
+    }
+
+    // Calls f on every entry in the queue, oldest first.
+    template <typename F>
+    void forEach(F f) const {
+        for (PassengerEntry* e = (head.*Next).load(std::memory_order_acquire); e != nullptr; e = (e->*Next).load(std::memory_order_acquire)) {
+            f(*e);
+        }
+    }
+
+    // Unlinks every entry for which served(entry) returns true, except the newest one: its link may still be written by
+    // a push in progress, so it stays until a later entry follows it. Lock-free with respect to push() and forEach(),
+    // but only one thread may remove from a queue at a time. Each entry is unlinked once, so the cost is O(1) per entry
+    // over the life of the queue, plus O(1) per entry still queued. served may push the entry to another queue.
+    template <typename F>
+    void removeIf(F served) {
+        PassengerEntry* previous = &head;
+        PassengerEntry* e = (head.*Next).load(std::memory_order_acquire);
+        while (e != nullptr) {
+            // A non-null link is final: push() writes an entry's link once, and only the consumer rewrites links.
+            PassengerEntry* next = (e->*Next).load(std::memory_order_acquire);
+            if (next != nullptr && served(*e)) {
+                (previous->*Next).store(next, std::memory_order_release);
+            }
+            else {
+                previous = e;
+            }
+            e = next;
+        }
+    }
+
+    // Forgets all entries, so that their storage can be released. Not safe while other threads use the queue.
+    void clear() {
+        (head.*Next).store(nullptr);
+        tail.store(&head);
+    }
+
+private:
+    PassengerEntry head; // Dummy entry in front of the oldest one
+    std::atomic<PassengerEntry*> tail{ &head }; // Newest entry, or the dummy when empty
+};
+
+using PickupQueue = PassengerQueue<&PassengerEntry::nextWaiting>;
+using DestinationBucket = PassengerQueue<&PassengerEntry::nextInCar>;
+using DeliveredList = PassengerQueue<&PassengerEntry::nextDelivered>;
+
+// Compares the old map + vector + find_if request table behind two mutexes with the lock-free queues, with every
+// thread joining, boarding and leaving through the same (lobby) floor.
+void benchmarkFloorQueues(int threads, int passengersPerThread);
+
+#endif
@@ -0,0 +1,144 @@
+// CMP202
+// Elevator System Simulation
+// Passenger latency metrics -- lock-free HDR-style histograms of wait, ride and capacity-block time, per floor
+
+#include <bit>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "Metrics.h"
+using namespace std;
+
+PassengerMetrics passengerMetrics;
+
+const char* metricName(Metric metric) {
+    switch (metric) {
+    case Metric::Wait: return "wait";
+    case Metric::Ride: return "ride";
+    case Metric::CapacityBlock: return "capacity_block";
+    default: return "unknown";
+    }
+}
+
+int histogramBucket(uint64_t micros) {
+    if (micros < 2 * HISTOGRAM_SUB_BUCKETS) return static_cast<int>(micros);
+    int shift = bit_width(micros) - 1 - HISTOGRAM_SUB_BUCKET_BITS; // Keeps the top HISTOGRAM_SUB_BUCKET_BITS + 1 bits.
+    int bucket = (shift + 1) * HISTOGRAM_SUB_BUCKETS + static_cast<int>((micros >> shift) - HISTOGRAM_SUB_BUCKETS);
+    return min(bucket, HISTOGRAM_BUCKETS - 1);
+}
+
+uint64_t histogramBucketLow(int bucket) {
+    if (bucket < 2 * HISTOGRAM_SUB_BUCKETS) return bucket;
+    int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    return static_cast<uint64_t>(bucket % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS) << shift;
+}
+
+uint64_t histogramBucketHigh(int bucket) {
+    return bucket + 1 < HISTOGRAM_BUCKETS ? histogramBucketLow(bucket + 1) - 1 : UINT64_MAX;
+}
+
+void HistogramSummary::merge(const HistogramSummary& other) {
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) counts[b] += other.counts[b];
+    total += other.total;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
+
+uint64_t HistogramSummary::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= rank) return std::min(histogramBucketHigh(b), max);
+    }
+    return max;
+}
+
+// Shard used by the calling thread, handed out round robin the first time a thread records.
+static int threadShard() {
+    static atomic<int> nextShard(0);
+    thread_local int shard = nextShard.fetch_add(1, memory_order_relaxed) % PassengerMetrics::SHARDS;
+    return shard;
+}
+
+void PassengerMetrics::record(Metric metric, int floor, long long nanoseconds) {
+    uint64_t micros = nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds / 1000) : 0;
+    int m = static_cast<int>(metric);
+    Shard& shard = shards[threadShard()];
+    shard.counts[m][floor][histogramBucket(micros)].fetch_add(1, memory_order_relaxed);
+    shard.sum[m][floor].fetch_add(micros, memory_order_relaxed);
+    uint64_t seen = shard.max[m][floor].load(memory_order_relaxed);
+    while (micros > seen && !shard.max[m][floor].compare_exchange_weak(seen, micros, memory_order_relaxed)) {}
+}
+
+HistogramSummary PassengerMetrics::summary(Metric metric, int floor) const {
+    HistogramSummary s;
+    int m = static_cast<int>(metric);
+    for (int f = 0; f < TOTAL_LEVELS; f++) {
+        if (floor != -1 && f != floor) continue;
+        for (const Shard& shard : shards) {
+            for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                uint64_t count = shard.counts[m][f][b].load(memory_order_relaxed);
+                s.counts[b] += count;
+                s.total += count;
+            }
+            s.sum += shard.sum[m][f].load(memory_order_relaxed);
+            s.max = max(s.max, shard.max[m][f].load(memory_order_relaxed));
+        }
+    }
+    return s;
+}
+
+void PassengerMetrics::printSummary() const {
+    cout << left << setw(16) << "metric" << right << setw(10) << "count" << setw(14) << "mean ms"
+        << setw(14) << "p50 ms" << setw(14) << "p99 ms" << setw(14) << "max ms" << endl;
+    for (int m = 0; m < static_cast<int>(Metric::Count); m++) {
+        HistogramSummary s = summary(static_cast<Metric>(m), -1);
+        cout << left << setw(16) << metricName(static_cast<Metric>(m)) << right << setw(10) << s.total << fixed << setprecision(1)
+            << setw(14) << s.mean() / 1000 << setw(14) << s.percentile(50) / 1000.0
+            << setw(14) << s.percentile(99) / 1000.0 << setw(14) << s.max / 1000.0 << endl;
+        cout.unsetf(ios::fixed);
+    }
+}
+
+bool PassengerMetrics::exportFile(const string& path) const {
+    ofstream out(path);
+    if (!out) return false;
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+
+    // One histogram per metric and floor, plus "all" floors; only non-empty buckets are written.
+    if (json) out << "{\n  \"unit\": \"microseconds\",\n  \"histograms\": [";
+    else out << "metric,floor,count,mean_us,p50_us,p99_us,max_us,bucket_low_us,bucket_high_us,bucket_count\n";
+    bool first = true;
+    for (int m = 0; m < static_cast<int>(Metric::Count); m++) {
+        for (int floor = -1; floor < TOTAL_LEVELS; floor++) {
+            HistogramSummary s = summary(static_cast<Metric>(m), floor);
+            string floorName = floor == -1 ? "all" : to_string(floor);
+            if (json) {
+                out << (first ? "\n" : ",\n") << "    {\"metric\": \"" << metricName(static_cast<Metric>(m)) << "\", \"floor\": \"" << floorName
+                    << "\", \"count\": " << s.total << ", \"mean\": " << s.mean() << ", \"p50\": " << s.percentile(50)
+                    << ", \"p99\": " << s.percentile(99) << ", \"max\": " << s.max << ", \"buckets\": [";
+                bool firstBucket = true;
+                for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                    if (s.counts[b] == 0) continue;
+                    out << (firstBucket ? "" : ", ") << "[" << histogramBucketLow(b) << ", " << histogramBucketHigh(b) << ", " << s.counts[b] << "]";
+                    firstBucket = false;
+                }
+                out << "]}";
+                first = false;
+            }
+            else {
+                for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                    if (s.counts[b] == 0) continue;
+                    out << metricName(static_cast<Metric>(m)) << "," << floorName << "," << s.total << "," << s.mean() << ","
+                        << s.percentile(50) << "," << s.percentile(99) << "," << s.max << ","
+                        << histogramBucketLow(b) << "," << histogramBucketHigh(b) << "," << s.counts[b] << "\n";
+                }
+            }
+        }
+    }
+    if (json) out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
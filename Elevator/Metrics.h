@@ -0,0 +1,73 @@
+// CMP202
+// Elevator System Simulation
+// Passenger latency metrics -- lock-free HDR-style histograms of wait, ride and capacity-block time, per floor
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Elevator.h"
+
+// What is measured for each passenger.
+enum class Metric {
+    Wait, // From the pickup request to boarding, keyed by start floor
+    Ride, // From boarding to exiting, keyed by destination floor
+    CapacityBlock, // Time blocked in elevatorCapacity.acquire() because the elevator was full, keyed by start floor
+    Count
+};
+
+const char* metricName(Metric metric);
+
+// Histogram buckets, HDR style: values below 2 * HISTOGRAM_SUB_BUCKETS microseconds get a bucket each, and every
+// power of two above that is split into HISTOGRAM_SUB_BUCKETS buckets, so each bucket is within about 6% of its value.
+constexpr int HISTOGRAM_SUB_BUCKET_BITS = 4;
+constexpr int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+constexpr int HISTOGRAM_MAX_BITS = 40; // Values up to 2^40 microseconds (about 12 days); longer ones go in the last bucket
+constexpr int HISTOGRAM_BUCKETS = (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS;
+
+int histogramBucket(uint64_t micros); // Bucket holding a value
+uint64_t histogramBucketLow(int bucket); // Smallest value in a bucket
+uint64_t histogramBucketHigh(int bucket); // Largest value in a bucket
+
+// A merged, non-atomic copy of a histogram, used for reporting.
+struct HistogramSummary {
+    std::vector<uint64_t> counts = std::vector<uint64_t>(HISTOGRAM_BUCKETS);
+    uint64_t total = 0; // Number of values
+    uint64_t sum = 0; // Sum of the values, in microseconds
+    uint64_t max = 0; // Largest value, in microseconds
+
+    void merge(const HistogramSummary& other);
+    double mean() const { return total > 0 ? static_cast<double>(sum) / total : 0; }
+    uint64_t percentile(double p) const; // Upper bound of the bucket holding the p-th percentile (0-100)
+};
+
+// Histograms of every metric for every floor. Recording is lock-free: the histograms are split into shards and each
+// thread always records into the same shard with relaxed atomic increments, so threads on different shards never touch
+// the same cache line. Shards are merged only when the results are read, at the end of a run.
+class PassengerMetrics {
+public:
+    static constexpr int SHARDS = 16;
+
+    void record(Metric metric, int floor, long long nanoseconds); // Safe to call from any thread
+
+    HistogramSummary summary(Metric metric, int floor) const; // floor -1 is all floors together
+    void printSummary() const; // Count, mean, p50, p99 and max of every metric over all floors
+    bool exportFile(const std::string& path) const; // JSON if the path ends in ".json", CSV otherwise
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> counts[static_cast<int>(Metric::Count)][TOTAL_LEVELS][HISTOGRAM_BUCKETS];
+        std::atomic<uint64_t> sum[static_cast<int>(Metric::Count)][TOTAL_LEVELS];
+        std::atomic<uint64_t> max[static_cast<int>(Metric::Count)][TOTAL_LEVELS];
+    };
+
+    Shard shards[SHARDS];
+};
+
+extern PassengerMetrics passengerMetrics; // Metrics of the threaded simulation
+
+#endif
@@ -0,0 +1,175 @@
+// CMP202
+// Elevator System Simulation
+// Renderer -- draws the building from snapshots on its own thread, at a fixed frame rate
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "Elevator.h"
+#include "Renderer.h"
+using namespace std;
+
+constexpr size_t EVENT_LOG_LINES = 5; // Number of recent messages shown under the building
+constexpr int SNAPSHOT_ATTEMPTS = 100; // Optimistic reads before a snapshot holds back new changes instead
+
+static atomic<bool> redrawRequested(true); // Set by requestRedraw(), cleared by the renderer when it draws
+static atomic<bool> rendering(false); // True while a renderer that draws is running
+static ProfiledMutex eventLogMutex("event log"); // Protects eventLog
+static deque<string> eventLog; // Most recent messages, oldest first
+
+// A version check for many writers: a snapshot is consistent if no change was in progress when it started or ended
+// and none finished in between. Changes count themselves finished before they stop counting as in progress.
+// If changes keep overlapping the reads, the snapshot sets changesHeld: new changes wait until it is cleared, and the
+// snapshot reads once the changes already in progress have finished.
+static atomic<int> changesInProgress(0);
+static atomic<unsigned long long> changesFinished(0);
+static atomic<bool> changesHeld(false);
+static mutex holdMutex; // One snapshot holds the changes at a time
+
+BuildingChange::BuildingChange() {
+    for (;;) {
+        changesInProgress++;
+        if (!changesHeld) return; // Seen after counting ourselves, so a snapshot that holds changes waits for us.
+        changesInProgress--; // Not a change yet: nothing to count as finished.
+        while (changesHeld) this_thread::yield();
+    }
+}
+
+BuildingChange::~BuildingChange() {
+    changesFinished++;
+    changesInProgress--;
+}
+
+// Reads the building once, without checking for changes.
+static BuildingSnapshot readBuilding() {
+    BuildingSnapshot s;
+    s.level = currentLevel;
+    s.movingUp = ::movingUp; // The global, not the member of the same name.
+    s.delivered.resize(TOTAL_LEVELS);
+    s.waiting.resize(TOTAL_LEVELS);
+    for (int i = 0; i < TOTAL_LEVELS; i++) {
+        passengersInsideElevator[i].forEach([&](const PassengerEntry& passenger) {
+            if (passenger.state == PassengerEntry::Riding) s.riding.emplace_back(passenger.id, passenger.destinationFloor);
+        });
+        deliveredPassengers[i].forEach([&](const PassengerEntry& passenger) {
+            if (passenger.state == PassengerEntry::Delivered) s.delivered[i].emplace_back(passenger.id, passenger.destinationFloor);
+        });
+        pickupRequests[i].forEach([&](const PassengerEntry& passenger) {
+            if (passenger.state == PassengerEntry::Waiting) s.waiting[i].emplace_back(passenger.id, passenger.destinationFloor);
+        });
+    }
+    return s;
+}
+
+BuildingSnapshot BuildingSnapshot::take() {
+    for (int attempt = 0; attempt < SNAPSHOT_ATTEMPTS; attempt++) {
+        unsigned long long finished = changesFinished;
+        if (changesInProgress == 0) {
+            BuildingSnapshot s = readBuilding();
+            if (changesInProgress == 0 && changesFinished == finished) return s;
+        }
+        this_thread::yield(); // Changes are short; let them finish.
+    }
+
+    // Too busy to find a gap: hold back new changes, wait for the ones in progress, then read.
+    lock_guard<mutex> lock(holdMutex);
+    changesHeld = true;
+    while (changesInProgress != 0) this_thread::yield();
+    BuildingSnapshot s = readBuilding();
+    changesHeld = false;
+    return s;
+}
+
+void requestRedraw() {
+    redrawRequested.store(true, memory_order_relaxed);
+}
+
+void logEvent(const string& message) {
+    if (!rendering) { // No display to show it under: print it as a line of its own.
+        lock_guard<ProfiledMutex> lock(coutMutex);
+        cout << message << endl;
+        return;
+    }
+    lock_guard<ProfiledMutex> lock(eventLogMutex);
+    eventLog.push_back(message);
+    if (eventLog.size() > EVENT_LOG_LINES) eventLog.pop_front();
+}
+
+// Function to print a snapshot of the building and elevator.
+static void printBuilding(const BuildingSnapshot& s) {
+    ostringstream frame; // The whole frame is built first and written with one call, to avoid flicker.
+    frame << "\033[2J\033[H"; // ANSI escape codes: clear the screen and move the cursor home, without starting a shell.
+    for (int i = TOTAL_LEVELS - 1; i >= 0; --i) { // Iterates over each floor from top to bottom.
+        frame << "Floor " << i << ": ";
+        if (i == s.level) { // Checks if the elevator is at the current floor.
+            // Displays the elevator's status, direction, and passenger count.
+            frame << "[E: ";
+            frame << (s.movingUp ? "Up" : "Down") << ", P: " << s.riding.size() << "/" << MAX_CAPACITY << " ";
+            for (size_t index = 0; index < s.riding.size(); ++index) { // Iterates over passengers in the elevator.
+                const auto& passenger = s.riding[index];
+                // Displays passenger ID and destination floor with color coding.
+                frame << "\033[35m" << passenger.first << "t" << passenger.second << "\033[0m";
+                if (index < s.riding.size() - 1) {
+                    frame << ", "; // Comma between passengers for readability.
+                }
+            }
+            frame << "] ";
+        }
+        else {
+            // Fills the line for floors without the elevator for alignment.
+            frame << "                                     ";
+        }
+
+        // Delivered passengers
+        for (auto& passenger : s.delivered[i]) { // Iterates over delivered passengers at the current floor.
+            // Displays delivered passenger ID and destination floor with color coding.
+            frame << "\033[32m" << passenger.first << "t" << passenger.second << "\033[0m ";
+        }
+
+        // Waiting passengers
+        for (auto& passenger : s.waiting[i]) { // Iterates over waiting passengers at the current floor.
+            // Displays waiting passenger ID and destination floor with color coding.
+            frame << "  \033[31m" << passenger.first << "t" << passenger.second << "\033[0m ";
+        }
+
+        frame << "\n"; // New line for the next floor.
+    }
+    frame << "\n---------------------------------------\n";
+    {
+        lock_guard<ProfiledMutex> lock(eventLogMutex);
+        for (const string& message : eventLog) frame << message << "\n";
+    }
+
+    lock_guard<ProfiledMutex> lock(coutMutex); // Ensures exclusive access to std::cout.
+    cout << frame.str() << flush;
+}
+
+Renderer::Renderer(int framesPerSecond, bool headless) : framesPerSecond(framesPerSecond > 0 ? framesPerSecond : 1), headless(headless) {
+    if (headless) return; // Renders nothing, so there is no need for a thread.
+    rendering = true;
+    thread = std::thread(&Renderer::run, this);
+}
+
+void Renderer::stop() {
+    if (headless || !running) return;
+    running = false;
+    thread.join();
+    printBuilding(BuildingSnapshot::take()); // Final state, whether or not it changed since the last frame.
+    rendering = false;
+}
+
+void Renderer::run() {
+    auto frameInterval = chrono::microseconds(1000000 / framesPerSecond);
+    auto nextFrame = chrono::steady_clock::now();
+    while (running) {
+        nextFrame += frameInterval;
+        this_thread::sleep_until(nextFrame); // Rate limit: however many events happened, at most one frame per interval.
+        if (redrawRequested.exchange(false, memory_order_relaxed)) {
+            printBuilding(BuildingSnapshot::take());
+        }
+    }
+}
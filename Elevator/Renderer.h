@@ -0,0 +1,68 @@
+// CMP202
+// Elevator System Simulation
+// Renderer -- draws the building from snapshots on its own thread, at a fixed frame rate
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Brackets a change to what the display shows: a passenger joining a queue and changing state, or the elevator moving.
+// Changes may overlap each other; BuildingSnapshot::take() reads again if any overlapped its reads, and if that keeps
+// happening it makes new changes wait here while it reads.
+class BuildingChange {
+public:
+    BuildingChange();
+    ~BuildingChange();
+
+    BuildingChange(const BuildingChange&) = delete;
+    BuildingChange& operator=(const BuildingChange&) = delete;
+};
+
+// A copy of everything the display shows, normally taken without stopping the simulation. It is consistent: take()
+// reads again until no BuildingChange began or ended during its reads, so the elevator's floor and every passenger's
+// place are from the same moment and no passenger is shown twice or not at all. After a bounded number of attempts it
+// holds back new changes for one read instead, so a busy building cannot keep the renderer from drawing.
+struct BuildingSnapshot {
+    int level = 0; // Floor of the elevator
+    bool movingUp = true; // Direction of the elevator
+    std::vector<std::pair<int, int>> riding; // Passengers in the elevator (ID, destination floor)
+    std::vector<std::vector<std::pair<int, int>>> delivered; // Delivered passengers per floor
+    std::vector<std::vector<std::pair<int, int>>> waiting; // Waiting passengers per floor
+
+    static BuildingSnapshot take(); // Reads the current state of the simulation, waiting out changes in progress
+};
+
+// Tells the renderer that the building has changed. Cheap enough to call from any thread on every event.
+void requestRedraw();
+
+// Adds a line to the messages shown under the building (e.g. "Passenger 3 exited at floor 7"), or prints it on its own
+// line when no renderer is drawing (headless).
+void logEvent(const std::string& message);
+
+// Redraws the building on a separate thread, at most framesPerSecond times a second and only after a change, so that
+// passengers and the elevator never wait for the console. A headless renderer draws nothing (used for load tests).
+class Renderer {
+public:
+    Renderer(int framesPerSecond, bool headless);
+    ~Renderer() { stop(); }
+
+    void stop(); // Draws the final frame and stops the thread; does nothing if already stopped
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+private:
+    void run(); // Renderer thread loop
+
+    int framesPerSecond;
+    bool headless;
+    std::atomic<bool> running{ true };
+    std::thread thread;
+};
+
+#endif
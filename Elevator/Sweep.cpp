@@ -0,0 +1,210 @@
+// CMP202
+// Elevator System Simulation
+// Parameter sweep -- many independent simulations of a grid of buildings, spread across all cores
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "Sweep.h"
+using namespace std;
+
+// Statistics of one simulation run.
+struct RunOutcome {
+    double throughput, averageWait, p99Wait, averageJourney, p99Journey;
+};
+
+static SweepStatistic aggregate(const vector<RunOutcome>& runs, double RunOutcome::* field) {
+    SweepStatistic s;
+    if (runs.empty()) return s;
+    for (const RunOutcome& r : runs) s.mean += r.*field;
+    s.mean /= runs.size();
+    if (runs.size() > 1) {
+        double squares = 0;
+        for (const RunOutcome& r : runs) squares += (r.*field - s.mean) * (r.*field - s.mean);
+        s.stddev = sqrt(squares / (runs.size() - 1));
+    }
+    return s;
+}
+
+vector<SweepResult> runSweep(const SweepGrid& grid, unsigned int threads) {
+    // Every combination of the grid.
+    vector<SweepResult> results;
+    for (int levels : grid.levels)
+        for (int capacity : grid.capacities)
+            for (int cars : grid.cars)
+                for (SimTime move : grid.moveDurations)
+                    for (SimTime stop : grid.stopDurations)
+                        for (const string& dispatcher : grid.dispatchers) {
+                            SweepResult r;
+                            r.config = SimulationConfig{ levels, capacity, move, stop, cars };
+                            r.dispatcher = dispatcher;
+                            r.runs = grid.seeds;
+                            results.push_back(r);
+                        }
+
+    // One job per configuration and seed; the threads take the next job from a shared counter until none are left.
+    size_t jobs = results.size() * grid.seeds;
+    vector<RunOutcome> outcomes(jobs);
+    atomic<size_t> nextJob(0);
+    auto worker = [&]() {
+        for (size_t job = nextJob++; job < jobs; job = nextJob++) {
+            const SweepResult& r = results[job / grid.seeds];
+            WorkloadConfig workload;
+            workload.pattern = grid.pattern;
+            workload.arrivalsPerHour = grid.arrivalsPerHour;
+            workload.duration = static_cast<SimTime>(grid.hours * 3600 * 1000);
+            workload.levels = r.config.levels;
+            workload.seed = grid.firstSeed + job % grid.seeds;
+
+            EventSimulation sim(r.config, makeDispatcher(r.dispatcher));
+            addTrips(sim, generateWorkload(workload));
+            sim.run();
+
+            SimulationStats s = sim.stats();
+            double hours = s.simulatedTime / 3600000.0;
+            outcomes[job] = RunOutcome{ hours > 0 ? s.delivered / hours : 0, s.averageWait, s.p99Wait, s.averageJourney, s.p99Journey };
+        }
+    };
+
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    vector<thread> pool;
+    for (unsigned int t = 0; t < threads; t++) pool.emplace_back(worker);
+    for (auto& t : pool) t.join();
+
+    for (size_t i = 0; i < results.size(); i++) {
+        vector<RunOutcome> runs(outcomes.begin() + i * grid.seeds, outcomes.begin() + (i + 1) * grid.seeds);
+        results[i].throughput = aggregate(runs, &RunOutcome::throughput);
+        results[i].averageWait = aggregate(runs, &RunOutcome::averageWait);
+        results[i].p99Wait = aggregate(runs, &RunOutcome::p99Wait);
+        results[i].averageJourney = aggregate(runs, &RunOutcome::averageJourney);
+        results[i].p99Journey = aggregate(runs, &RunOutcome::p99Journey);
+    }
+    return results;
+}
+
+void writeSweepCsv(ostream& out, const vector<SweepResult>& results) {
+    out << "levels,capacity,cars,move_ms,stop_ms,dispatcher,runs,"
+        "throughput_mean,throughput_sd,avg_wait_ms_mean,avg_wait_ms_sd,p99_wait_ms_mean,p99_wait_ms_sd,"
+        "avg_journey_ms_mean,avg_journey_ms_sd,p99_journey_ms_mean,p99_journey_ms_sd\n";
+    for (const SweepResult& r : results) {
+        out << r.config.levels << "," << r.config.capacity << "," << r.config.cars << "," << r.config.moveDuration << ","
+            << r.config.stopDuration << "," << r.dispatcher << "," << r.runs;
+        for (const SweepStatistic* s : { &r.throughput, &r.averageWait, &r.p99Wait, &r.averageJourney, &r.p99Journey }) {
+            out << "," << s->mean << "," << s->stddev;
+        }
+        out << "\n";
+    }
+}
+
+// Parses one value, which must be the whole text (so "10x" and "" are rejected).
+template <typename T>
+static bool parseValue(const string& text, T& value) {
+    istringstream field(text);
+    return field >> value && (field >> ws).eof();
+}
+
+// Parses a comma-separated list such as "10,20,40".
+template <typename T>
+static bool parseList(const string& text, vector<T>& values) {
+    values.clear();
+    istringstream in(text);
+    string item;
+    while (getline(in, item, ',')) {
+        T value;
+        if (!parseValue(item, value)) return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+int sweepMain(int argc, char* argv[]) {
+    SweepGrid grid;
+    unsigned int threads = 0;
+    string outFile;
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << option << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        if (option == "--levels") ok = parseList(value, grid.levels);
+        else if (option == "--capacity") ok = parseList(value, grid.capacities);
+        else if (option == "--cars") ok = parseList(value, grid.cars);
+        else if (option == "--move") ok = parseList(value, grid.moveDurations);
+        else if (option == "--stop") ok = parseList(value, grid.stopDurations);
+        else if (option == "--dispatch") ok = parseList(value, grid.dispatchers);
+        else if (option == "--pattern") ok = parsePattern(value, grid.pattern);
+        else if (option == "--rate") ok = parseValue(value, grid.arrivalsPerHour);
+        else if (option == "--hours") ok = parseValue(value, grid.hours);
+        else if (option == "--seeds") {
+            ok = parseValue(value, grid.seeds);
+            if (ok && grid.seeds < 1) {
+                cerr << "The sweep needs at least 1 seed" << endl;
+                return 1;
+            }
+        }
+        else if (option == "--threads") {
+            int count = 0; // Signed, so that "-1" is rejected instead of wrapping around.
+            ok = parseValue(value, count);
+            if (ok && count < 1) {
+                cerr << "The sweep needs at least 1 thread" << endl;
+                return 1;
+            }
+            threads = static_cast<unsigned int>(count);
+        }
+        else if (option == "--out") outFile = value;
+        else {
+            cerr << "Unknown sweep option " << option << endl;
+            return 1;
+        }
+        if (!ok) {
+            cerr << "Bad value for " << option << ": " << value << endl;
+            return 1;
+        }
+    }
+    for (const string& name : grid.dispatchers) {
+        if (!makeDispatcher(name)) {
+            cerr << "Unknown dispatcher " << name << endl;
+            return 1;
+        }
+    }
+    // checkConfig() tests every setting on its own, so checking each value of each list covers every combination.
+    auto allValid = [](auto setting, const auto& values) {
+        for (const auto& value : values) {
+            SimulationConfig config;
+            config.*setting = value;
+            if (!checkConfig(config)) return false;
+        }
+        return true;
+    };
+    if (!allValid(&SimulationConfig::levels, grid.levels) || !allValid(&SimulationConfig::capacity, grid.capacities) ||
+        !allValid(&SimulationConfig::cars, grid.cars) || !allValid(&SimulationConfig::moveDuration, grid.moveDurations) ||
+        !allValid(&SimulationConfig::stopDuration, grid.stopDurations) || !checkWorkload(grid.arrivalsPerHour, grid.hours)) {
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    vector<SweepResult> results = runSweep(grid, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (outFile.empty()) {
+        writeSweepCsv(cout, results);
+    }
+    else {
+        ofstream out(outFile);
+        writeSweepCsv(out, results);
+        if (!out) {
+            cerr << "Could not write " << outFile << endl;
+            return 1;
+        }
+    }
+    cerr << results.size() * grid.seeds << " simulations of " << results.size() << " configurations in " << seconds << " s" << endl;
+    return 0;
+}
@@ -0,0 +1,60 @@
+// CMP202
+// Elevator System Simulation
+// Parameter sweep -- many independent simulations of a grid of buildings, spread across all cores
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "EventSimulation.h"
+#include "Workload.h"
+
+// The configurations to sweep: every combination of the lists below is simulated once per seed.
+struct SweepGrid {
+    std::vector<int> levels = { TOTAL_LEVELS };
+    std::vector<int> capacities = { MAX_CAPACITY };
+    std::vector<int> cars = { 1 };
+    std::vector<SimTime> moveDurations = { MOVE_DURATION };
+    std::vector<SimTime> stopDurations = { STOP_DURATION };
+    std::vector<std::string> dispatchers = { "look" };
+
+    TrafficPattern pattern = TrafficPattern::Uniform; // Traffic every configuration is run with
+    double arrivalsPerHour = 300;
+    double hours = 1;
+    int seeds = 10; // Runs per configuration, with seeds firstSeed, firstSeed + 1, ...
+    uint64_t firstSeed = 1;
+};
+
+// Mean and standard deviation of one statistic over the seeds of a configuration.
+struct SweepStatistic {
+    double mean = 0;
+    double stddev = 0;
+};
+
+// Aggregated results of one configuration.
+struct SweepResult {
+    SimulationConfig config;
+    std::string dispatcher;
+    int runs = 0;
+    SweepStatistic throughput; // Passengers delivered per simulated hour
+    SweepStatistic averageWait; // Milliseconds
+    SweepStatistic p99Wait;
+    SweepStatistic averageJourney;
+    SweepStatistic p99Journey;
+};
+
+// Runs every configuration of the grid with every seed on the given number of threads (0 for all cores). Every run
+// has its own EventSimulation, so runs share nothing and need no locking.
+std::vector<SweepResult> runSweep(const SweepGrid& grid, unsigned int threads);
+
+// Writes the results as CSV, one line per configuration.
+void writeSweepCsv(std::ostream& out, const std::vector<SweepResult>& results);
+
+// Parses the sweep options after "--sweep" (see main()) and runs it. Returns the exit code.
+int sweepMain(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,255 @@
+// CMP202
+// Elevator System Simulation
+// Workloads -- seeded, reproducible traffic patterns and recorded traces for the discrete-event simulation
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "Workload.h"
+using namespace std;
+
+const char* patternName(TrafficPattern pattern) {
+    switch (pattern) {
+    case TrafficPattern::Uniform: return "uniform";
+    case TrafficPattern::UpPeak: return "up-peak";
+    case TrafficPattern::LunchTwoWay: return "lunch";
+    case TrafficPattern::DownPeak: return "down-peak";
+    }
+    return "unknown";
+}
+
+bool parsePattern(const string& name, TrafficPattern& pattern) {
+    for (TrafficPattern p : allPatterns()) {
+        if (name == patternName(p)) {
+            pattern = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+const vector<TrafficPattern>& allPatterns() {
+    static const vector<TrafficPattern> patterns = { TrafficPattern::Uniform, TrafficPattern::UpPeak, TrafficPattern::LunchTwoWay, TrafficPattern::DownPeak };
+    return patterns;
+}
+
+// Random numbers built directly on mt19937_64, whose output the standard fixes, instead of the standard
+// distributions, whose output differs between standard libraries: the same seed gives the same trace everywhere.
+class PortableRandom {
+public:
+    explicit PortableRandom(uint64_t seed) : engine(seed) {}
+
+    double uniform() { return (engine() >> 11) * 0x1.0p-53; } // In [0, 1)
+    int below(int n) { return static_cast<int>(uniform() * n); } // In [0, n)
+    double exponential(double mean) { return -log(1.0 - uniform()) * mean; }
+
+private:
+    mt19937_64 engine;
+};
+
+// Picks a floor in [1, levels) (any floor but the lobby).
+static int upperFloor(PortableRandom& rng, int levels) {
+    return 1 + rng.below(levels - 1);
+}
+
+// Picks start and destination for one trip. fromLobby and toLobby are the shares of trips from and to floor 0; the rest
+// go between two random upper floors.
+static void pickFloors(PortableRandom& rng, int levels, double fromLobby, double toLobby, int& start, int& destination) {
+    double r = rng.uniform();
+    if (r < fromLobby) {
+        start = 0;
+        destination = upperFloor(rng, levels);
+    }
+    else if (r < fromLobby + toLobby) {
+        start = upperFloor(rng, levels);
+        destination = 0;
+    }
+    else {
+        start = rng.below(levels);
+        do {
+            destination = rng.below(levels); // Ensures destination floor is different from start floor.
+        } while (destination == start);
+    }
+}
+
+bool checkWorkload(double arrivalsPerHour, double hours) {
+    if (!(arrivalsPerHour > 0) || !isfinite(arrivalsPerHour)) cerr << "The arrival rate must be a positive number per hour" << endl;
+    else if (!(hours > 0) || !isfinite(hours)) cerr << "The workload must last a positive number of hours" << endl;
+    else return true;
+    return false;
+}
+
+vector<TripRequest> generateWorkload(const WorkloadConfig& config) {
+    // A negative rate would move the clock backwards forever, and 0 would divide by zero (checkWorkload() says why).
+    if (!(config.arrivalsPerHour > 0) || !isfinite(config.arrivalsPerHour) || config.duration <= 0) return {};
+    PortableRandom rng(config.seed);
+    double meanGap = 3600.0 * 1000 / config.arrivalsPerHour; // Milliseconds between arrivals on average.
+
+    vector<TripRequest> trips;
+    double time = rng.exponential(meanGap);
+    while (time < config.duration) {
+        TripRequest trip{ static_cast<SimTime>(time), 0, 0 };
+        switch (config.pattern) {
+        case TrafficPattern::Uniform: pickFloors(rng, config.levels, 0, 0, trip.startFloor, trip.destinationFloor); break;
+        case TrafficPattern::UpPeak: pickFloors(rng, config.levels, 0.85, 0.05, trip.startFloor, trip.destinationFloor); break;
+        case TrafficPattern::LunchTwoWay: pickFloors(rng, config.levels, 0.45, 0.45, trip.startFloor, trip.destinationFloor); break;
+        case TrafficPattern::DownPeak: pickFloors(rng, config.levels, 0.05, 0.85, trip.startFloor, trip.destinationFloor); break;
+        }
+        trips.push_back(trip);
+        time += rng.exponential(meanGap);
+    }
+    return trips;
+}
+
+static bool isBinaryTrace(const string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+}
+
+// Binary trace layout, little-endian: "ELVT", uint32 version, uint64 trip count, then per trip int64 time (ms),
+// uint16 start floor and uint16 destination floor.
+static const char TRACE_MAGIC[4] = { 'E', 'L', 'V', 'T' };
+constexpr uint32_t TRACE_VERSION = 1;
+
+static void writeLittleEndian(ostream& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+static bool readLittleEndian(istream& in, uint64_t& value, int bytes) {
+    value = 0;
+    for (int i = 0; i < bytes; i++) {
+        int c = in.get();
+        if (c == EOF) return false;
+        value |= static_cast<uint64_t>(c) << (8 * i);
+    }
+    return true;
+}
+
+bool saveTrace(const string& path, const vector<TripRequest>& trips) {
+    ofstream out(path, ios::binary);
+    if (!out) {
+        cerr << "Could not open " << path << " for writing" << endl;
+        return false;
+    }
+    if (isBinaryTrace(path)) {
+        out.write(TRACE_MAGIC, sizeof TRACE_MAGIC);
+        writeLittleEndian(out, TRACE_VERSION, 4);
+        writeLittleEndian(out, trips.size(), 8);
+        for (const TripRequest& trip : trips) {
+            writeLittleEndian(out, static_cast<uint64_t>(trip.time), 8);
+            writeLittleEndian(out, static_cast<uint64_t>(trip.startFloor), 2);
+            writeLittleEndian(out, static_cast<uint64_t>(trip.destinationFloor), 2);
+        }
+    }
+    else {
+        out << "time_ms,start_floor,destination_floor\n";
+        for (const TripRequest& trip : trips) out << trip.time << "," << trip.startFloor << "," << trip.destinationFloor << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool loadTrace(const string& path, vector<TripRequest>& trips) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        cerr << "Could not open " << path << endl;
+        return false;
+    }
+    trips.clear();
+
+    if (isBinaryTrace(path)) {
+        char magic[4];
+        uint64_t version, count;
+        if (!in.read(magic, sizeof magic) || !equal(magic, magic + 4, TRACE_MAGIC) || !readLittleEndian(in, version, 4) || version != TRACE_VERSION || !readLittleEndian(in, count, 8)) {
+            cerr << path << " is not a version " << TRACE_VERSION << " elevator trace" << endl;
+            return false;
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t time, start, destination;
+            if (!readLittleEndian(in, time, 8) || !readLittleEndian(in, start, 2) || !readLittleEndian(in, destination, 2)) {
+                cerr << path << " is truncated after " << i << " of " << count << " trips" << endl;
+                return false;
+            }
+            trips.push_back(TripRequest{ static_cast<SimTime>(time), static_cast<int>(start), static_cast<int>(destination) });
+        }
+        return true;
+    }
+
+    string line;
+    getline(in, line); // Header
+    for (int lineNumber = 2; getline(in, line); lineNumber++) {
+        if (line.empty()) continue;
+        istringstream fields(line);
+        TripRequest trip;
+        char comma1, comma2;
+        if (!(fields >> trip.time >> comma1 >> trip.startFloor >> comma2 >> trip.destinationFloor) || comma1 != ',' || comma2 != ',') {
+            cerr << path << ":" << lineNumber << ": expected time_ms,start_floor,destination_floor" << endl;
+            return false;
+        }
+        trips.push_back(trip);
+    }
+    return true;
+}
+
+bool addTrips(EventSimulation& sim, const vector<TripRequest>& trips) {
+    int levels = sim.config().levels;
+    for (const TripRequest& trip : trips) {
+        if (trip.startFloor < 0 || trip.startFloor >= levels || trip.destinationFloor < 0 || trip.destinationFloor >= levels || trip.startFloor == trip.destinationFloor) {
+            cerr << "Trip at " << trip.time << " ms from floor " << trip.startFloor << " to " << trip.destinationFloor
+                << " does not fit a building of " << levels << " floors" << endl;
+            return false;
+        }
+        sim.addPassenger(trip.startFloor, trip.destinationFloor, trip.time);
+    }
+    return true;
+}
+
+static void printReportHeader() {
+    cout << left << setw(12) << "workload" << right << setw(10) << "trips" << setw(16) << "delivered/hour"
+        << setw(11) << "avg wait" << setw(11) << "p99 wait" << setw(13) << "avg journey" << setw(13) << "p99 journey" << setw(11) << "wall ms" << endl;
+}
+
+// Runs the trips and prints one line of the report.
+static bool reportRun(const string& label, const vector<TripRequest>& trips, const SimulationConfig& config, const string& dispatcher) {
+    EventSimulation sim(config, makeDispatcher(dispatcher));
+    if (!addTrips(sim, trips)) return false;
+    auto start = chrono::steady_clock::now();
+    sim.run();
+    double wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    SimulationStats s = sim.stats();
+    double hours = s.simulatedTime / 3600000.0;
+    cout << left << setw(12) << label << right << setw(10) << trips.size() << fixed << setprecision(1)
+        << setw(16) << (hours > 0 ? s.delivered / hours : 0)
+        << setw(10) << s.averageWait / 1000 << "s" << setw(10) << s.p99Wait / 1000 << "s"
+        << setw(12) << s.averageJourney / 1000 << "s" << setw(12) << s.p99Journey / 1000 << "s" << setw(11) << wallMs << endl;
+    cout.unsetf(ios::fixed);
+    return true;
+}
+
+void benchmarkWorkloads(const SimulationConfig& sim, const string& dispatcher, double arrivalsPerHour, double hours, uint64_t seed) {
+    cout << sim.levels << " floors, " << sim.cars << " cars of " << sim.capacity << ", " << dispatcher << " dispatch, "
+        << arrivalsPerHour << " arrivals/hour for " << hours << " h (seed " << seed << ")" << endl;
+    printReportHeader();
+    for (TrafficPattern pattern : allPatterns()) {
+        WorkloadConfig workload;
+        workload.pattern = pattern;
+        workload.arrivalsPerHour = arrivalsPerHour;
+        workload.duration = static_cast<SimTime>(hours * 3600 * 1000);
+        workload.levels = sim.levels;
+        workload.seed = seed;
+        reportRun(patternName(pattern), generateWorkload(workload), sim, dispatcher);
+    }
+}
+
+bool replayTrace(const string& path, const SimulationConfig& sim, const string& dispatcher) {
+    vector<TripRequest> trips;
+    if (!loadTrace(path, trips)) return false;
+    cout << sim.levels << " floors, " << sim.cars << " cars of " << sim.capacity << ", " << dispatcher << " dispatch, trace " << path << endl;
+    printReportHeader();
+    return reportRun("trace", trips, sim, dispatcher);
+}
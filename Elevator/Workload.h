@@ -0,0 +1,63 @@
+// CMP202
+// Elevator System Simulation
+// Workloads -- seeded, reproducible traffic patterns and recorded traces for the discrete-event simulation
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "EventSimulation.h"
+
+// One passenger's trip: when the request is made, and between which floors.
+struct TripRequest {
+    SimTime time; // Arrival time in milliseconds from the start of the trace
+    int startFloor;
+    int destinationFloor;
+};
+
+// Shapes of traffic. Floor 0 is the lobby.
+enum class TrafficPattern {
+    Uniform, // Random start and destination floors
+    UpPeak, // Morning: most passengers go from the lobby up
+    LunchTwoWay, // Lunch: as many passengers go down to the lobby as come back up
+    DownPeak // Evening: most passengers go down to the lobby
+};
+
+const char* patternName(TrafficPattern pattern);
+bool parsePattern(const std::string& name, TrafficPattern& pattern); // Returns false for an unknown name
+const std::vector<TrafficPattern>& allPatterns();
+
+// Settings of a generated workload. The same settings always generate the same trips, on every platform.
+struct WorkloadConfig {
+    TrafficPattern pattern = TrafficPattern::Uniform;
+    double arrivalsPerHour = 300; // Mean rate of the Poisson arrival process
+    SimTime duration = 60LL * 60 * 1000; // Length of the generated period
+    int levels = TOTAL_LEVELS; // Floors of the building
+    uint64_t seed = 42;
+};
+
+// True if a workload of this rate and length can be generated: both positive and finite. Otherwise prints why to cerr.
+bool checkWorkload(double arrivalsPerHour, double hours);
+
+// Generates trips with Poisson arrivals (exponential gaps between requests) and floors chosen by the pattern. Generates
+// nothing if the rate or the duration is not positive.
+std::vector<TripRequest> generateWorkload(const WorkloadConfig& config);
+
+// Writes or reads a trace. Files ending in ".bin" use a compact binary format (12 bytes per trip), anything else is
+// CSV with the header "time_ms,start_floor,destination_floor". Both return false (and print why) on failure.
+bool saveTrace(const std::string& path, const std::vector<TripRequest>& trips);
+bool loadTrace(const std::string& path, std::vector<TripRequest>& trips);
+
+// Adds every trip to the simulation as a passenger. Returns false if a trip uses a floor the building does not have.
+bool addTrips(EventSimulation& sim, const std::vector<TripRequest>& trips);
+
+// Runs every traffic pattern through the simulation and reports throughput and latency, for regression testing.
+void benchmarkWorkloads(const SimulationConfig& sim, const std::string& dispatcher, double arrivalsPerHour, double hours, uint64_t seed);
+
+// Replays a recorded trace and reports throughput and latency.
+bool replayTrace(const std::string& path, const SimulationConfig& sim, const std::string& dispatcher);
+
+#endif
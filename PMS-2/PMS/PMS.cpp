@@ -5,6 +5,7 @@
 //------------------------------------------------------------
 // Include necessary headers for platform-specific code
 #if defined(_WIN32)
+    #define NOMINMAX      // Keeps windows.h from defining min and max macros, which break std::min and std::max
     #include <windows.h>  // Windows-specific header for system calls
     #include <psapi.h>
 #elif defined(__unix__) || defined(__APPLE__)
@@ -26,18 +27,34 @@
 #include <atomic>
 #include <mutex>
 #include <climits> // Include for INT_MAX
-
-const int THRESHOLD=10000000;//10'000'000
+#include <cstdint>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include "work_stealing_pool.h"
+#include "simd_sort.h"
+#include "merge_path.h"
+#include "sort_api.h"
+#include "radix_sort.h"
+#include "external_sort.h"
+#include "tuning.h"
+#include "sort_bench.h"
+#include "data_gen.h"
+#include "phase_profiler.h"
+#include "../../common/lock_profiler.h"
+
+int THRESHOLD=10000000;//10'000'000 until main() sets it from the tuning (tuning.h): smallest range split into two threads
+int TASK_THRESHOLD = 10000000; // Smallest range the pool sorts split into two tasks, also set from the tuning
 const size_t number_of_elements = 100; //Try 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000, and 1'000'000'000 depending on your computer resources. 
 //Stop execution if it exeeds more than 4-5 minutes and try differn configs.
 
 
-std::mutex cout_mutex;
+ProfiledMutex cout_mutex("cout");
 
 std::atomic<int> numThreads(0); 
 
 // Function to merge two halves of a vector
-void merge(std::vector<int>& array, int left, int mid, int right) {
+void merge(UntouchedVector<int>& array, int left, int mid, int right) {
     // Calculate the sizes of the two subarrays to be merged
     int n1 = mid - left + 1;
     int n2 = right - mid;
@@ -82,7 +99,7 @@ void merge(std::vector<int>& array, int left, int mid, int right) {
 }
 
 // Function to implement mergesort
-void mergesort(std::vector<int>& array, int left, int right) {
+void mergesort(UntouchedVector<int>& array, int left, int right) {
     if (left < right) {
         // Find the middle point to divide the array into halves
         int mid = left + (right - left) / 2;
@@ -97,7 +114,72 @@ void mergesort(std::vector<int>& array, int left, int right) {
     }
 }
 
-void parallel_mergesort(std::vector<int>& array, int left, int right) {
+// mergesort with its top depth levels split here, so that the benchmark's phase profile counts each of their merges as
+// its level and the ranges below them as leaf sorts, like the parallel versions (level: merges above this one).
+void profiled_mergesort(UntouchedVector<int>& array, int left, int right, int depth, int level = 0) {
+    if (left < right) {
+        int mid = left + (right - left) / 2;
+        if (depth > 0) {
+            profiled_mergesort(array, left, mid, depth - 1, level + 1);
+            profiled_mergesort(array, mid + 1, right, depth - 1, level + 1);
+        }
+        else {
+            PhaseScope leaves(Phase::LeafSort);
+            mergesort(array, left, mid);
+            mergesort(array, mid + 1, right);
+        }
+        PhaseScope merging(Phase::Merge, level);
+        merge(array, left, mid, right);
+    }
+}
+
+// Merges the sorted runs src[left, mid) and src[mid, right) straight into dst[left, right), with no temporary vectors.
+void merge_into(const int* src, int* dst, size_t left, size_t mid, size_t right) {
+    size_t i = left, j = mid, k = left;
+    while (i < mid && j < right) {
+        if (src[i] <= src[j]) dst[k++] = src[i++];
+        else dst[k++] = src[j++];
+    }
+    while (i < mid) dst[k++] = src[i++];
+    while (j < right) dst[k++] = src[j++];
+}
+
+// Sorts src[left, right) into dst[left, right). On entry both buffers hold the same elements; the halves are sorted
+// into src (using dst as their source), then merged into dst, so the two buffers swap roles at every level and the
+// merge never needs memory of its own.
+void pingpong_sort(int* src, int* dst, size_t left, size_t right) {
+    if (right - left < 2) return; // One element: src and dst already agree.
+    size_t mid = left + (right - left) / 2;
+    pingpong_sort(dst, src, left, mid);
+    pingpong_sort(dst, src, mid, right);
+    merge_into(src, dst, left, mid, right);
+}
+
+// pingpong_sort with its top depth levels of merges counted by the phase profile, as in profiled_mergesort()
+void profiled_pingpong_sort(int* src, int* dst, size_t left, size_t right, int depth, int level = 0) {
+    if (right - left < 2) return;
+    size_t mid = left + (right - left) / 2;
+    if (depth > 0) {
+        profiled_pingpong_sort(dst, src, left, mid, depth - 1, level + 1);
+        profiled_pingpong_sort(dst, src, mid, right, depth - 1, level + 1);
+    }
+    else {
+        PhaseScope leaves(Phase::LeafSort);
+        pingpong_sort(dst, src, left, mid);
+        pingpong_sort(dst, src, mid, right);
+    }
+    PhaseScope merging(Phase::Merge, level);
+    merge_into(src, dst, left, mid, right);
+}
+
+// Mergesort that allocates one auxiliary buffer per sort instead of two vectors per merge. The top depth levels are
+// split apart only for the phase profile.
+void pingpong_mergesort(UntouchedVector<int>& array, int depth = 0) {
+    std::vector<int> buffer(array.begin(), array.end()); // The only allocation: a copy of the input, used as the other buffer.
+    profiled_pingpong_sort(buffer.data(), array.data(), 0, array.size(), depth);
+}
+
+void parallel_mergesort(UntouchedVector<int>& array, int left, int right) {
     
     cout_mutex.lock();
     std::cout << "--Thread" << numThreads << ": start=" << left << " end=" << right << std::endl;
@@ -125,38 +207,161 @@ void parallel_mergesort(std::vector<int>& array, int left, int right) {
 }
 
 // Partially parallel version of the mergesort function (combination of threading and recursion)
-void partial_parallel_mergesort(std::vector<int>& array, int left, int right, int depth) {
+// level: merges above this one (0 at the top, where the final merge is made)
+void partial_parallel_mergesort(UntouchedVector<int>& array, int left, int right, int depth, int level = 0) {
     if (left < right) {
         // Declare 'mid' outside the if condition so it's accessible throughout the function
         int mid = left + (right - left) / 2;
 
         int size = right - left + 1;
-        if (size > THRESHOLD && depth > 0) {
+        if (size >= THRESHOLD && depth > 0) {
             // Increment thread count for new threads being created
             numThreads.fetch_add(2, std::memory_order_relaxed);
 
             // Parallel sorting for larger segments
-            std::thread leftThread([=, &array]() { partial_parallel_mergesort(array, left, mid, depth - 1); });
-            std::thread rightThread([=, &array]() { partial_parallel_mergesort(array, mid + 1, right, depth - 1); });
+            std::thread leftThread([=, &array]() { partial_parallel_mergesort(array, left, mid, depth - 1, level + 1); });
+            std::thread rightThread([=, &array]() { partial_parallel_mergesort(array, mid + 1, right, depth - 1, level + 1); });
 
             leftThread.join();
             rightThread.join();
         }
         else {
             // Sequential sorting for smaller segments or when maximum depth is reached
+            PhaseScope leaves(Phase::LeafSort);
             mergesort(array, left, mid);
             mergesort(array, mid + 1, right);
         }
 
         // Now 'mid' is defined in this scope, allowing the merge to proceed without error
+        PhaseScope merging(Phase::Merge, level); // Counted per level when the benchmark profiles phases
         merge(array, left, mid, right);
     }
 }
 
 
+// Task-based version of partial_parallel_mergesort: the two halves become tasks of a persistent work-stealing pool
+// instead of two new threads. The calling thread sorts the left half itself while the right half waits to be stolen by
+// an idle worker, so no thread ever sits in join and no threads are created per split.
+void task_parallel_mergesort(WorkStealingPool& pool, UntouchedVector<int>& array, int left, int right, int depth,
+                             int level = 0) {
+    if (left < right) {
+        int mid = left + (right - left) / 2;
+
+        int size = right - left + 1;
+        if (size >= TASK_THRESHOLD && depth > 0) {
+            // Parallel sorting for larger segments
+            pool.fork_join([&] { task_parallel_mergesort(pool, array, left, mid, depth - 1, level + 1); },
+                           [&] { task_parallel_mergesort(pool, array, mid + 1, right, depth - 1, level + 1); });
+        }
+        else {
+            // Sequential sorting for smaller segments or when maximum depth is reached
+            PhaseScope leaves(Phase::LeafSort);
+            mergesort(array, left, mid);
+            mergesort(array, mid + 1, right);
+        }
+
+        PhaseScope merging(Phase::Merge, level);
+        merge(array, left, mid, right);
+    }
+}
+
+// Parallel version of pingpong_sort on the work-stealing pool. Tasks work on disjoint ranges of the same two buffers,
+// so the whole sort still allocates one auxiliary buffer, whatever the number of workers.
+void task_pingpong_sort(WorkStealingPool& pool, int* src, int* dst, size_t left, size_t right, int depth, int level = 0) {
+    if (right - left < 2) return;
+    size_t mid = left + (right - left) / 2;
+    if (right - left >= static_cast<size_t>(TASK_THRESHOLD) && depth > 0) {
+        pool.fork_join([&] { task_pingpong_sort(pool, dst, src, left, mid, depth - 1, level + 1); },
+                       [&] { task_pingpong_sort(pool, dst, src, mid, right, depth - 1, level + 1); });
+    }
+    else {
+        PhaseScope leaves(Phase::LeafSort);
+        pingpong_sort(dst, src, left, mid);
+        pingpong_sort(dst, src, mid, right);
+    }
+    PhaseScope merging(Phase::Merge, level);
+    merge_into(src, dst, left, mid, right);
+}
+
+// The buffer is copied by the workers of the pool, so that its pages are placed near them (data_gen.h).
+void task_pingpong_mergesort(WorkStealingPool& pool, UntouchedVector<int>& array, int depth) {
+    std::unique_ptr<int[]> buffer = allocate_untouched<int>(array.size());
+    parallel_copy(pool, std::span<const int>(array), std::span<int>(buffer.get(), array.size()));
+    task_pingpong_sort(pool, buffer.get(), array.data(), 0, array.size(), depth);
+}
+
+// pingpong_sort with the kernels of simd_sort.h: ranges of up to SIMD_BLOCK elements are sorted in place in dst by the
+// small-block sort instead of being split further, and every merge uses merge_runs (AVX2 when the CPU has it).
+void simd_pingpong_sort(int* src, int* dst, size_t left, size_t right) {
+    if (right - left <= SIMD_BLOCK) {
+        sort_small_block(dst + left, right - left);
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+    simd_pingpong_sort(dst, src, left, mid);
+    simd_pingpong_sort(dst, src, mid, right);
+    merge_runs(src, dst, left, mid, right);
+}
+
+// simd_pingpong_sort with its top depth levels of merges counted by the phase profile, as in profiled_mergesort()
+void profiled_simd_pingpong_sort(int* src, int* dst, size_t left, size_t right, int depth, int level = 0) {
+    if (right - left <= SIMD_BLOCK) {
+        sort_small_block(dst + left, right - left);
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+    if (depth > 0) {
+        profiled_simd_pingpong_sort(dst, src, left, mid, depth - 1, level + 1);
+        profiled_simd_pingpong_sort(dst, src, mid, right, depth - 1, level + 1);
+    }
+    else {
+        PhaseScope leaves(Phase::LeafSort);
+        simd_pingpong_sort(dst, src, left, mid);
+        simd_pingpong_sort(dst, src, mid, right);
+    }
+    PhaseScope merging(Phase::Merge, level);
+    merge_runs(src, dst, left, mid, right);
+}
+
+void simd_pingpong_mergesort(UntouchedVector<int>& array, int depth = 0) {
+    std::vector<int> buffer(array.begin(), array.end());
+    profiled_simd_pingpong_sort(buffer.data(), array.data(), 0, array.size(), depth);
+}
+
+// task_pingpong_sort with the SIMD kernels. At the parallel levels the merge is split too (merge path), so the last
+// passes over the whole array do not run on one thread while the others wait.
+void task_simd_pingpong_sort(WorkStealingPool& pool, int* src, int* dst, size_t left, size_t right, int depth,
+                             int level = 0) {
+    if (right - left <= SIMD_BLOCK) {
+        sort_small_block(dst + left, right - left);
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+    if (right - left >= static_cast<size_t>(TASK_THRESHOLD) && depth > 0) {
+        pool.fork_join([&] { task_simd_pingpong_sort(pool, dst, src, left, mid, depth - 1, level + 1); },
+                       [&] { task_simd_pingpong_sort(pool, dst, src, mid, right, depth - 1, level + 1); });
+        PhaseScope merging(Phase::Merge, level); // The chunks run by other threads are counted as this phase too
+        parallel_merge(pool, src, dst, left, mid, right, pool.size());
+    }
+    else {
+        {
+            PhaseScope leaves(Phase::LeafSort);
+            simd_pingpong_sort(dst, src, left, mid);
+            simd_pingpong_sort(dst, src, mid, right);
+        }
+        PhaseScope merging(Phase::Merge, level);
+        merge_runs(src, dst, left, mid, right);
+    }
+}
+
+void task_simd_pingpong_mergesort(WorkStealingPool& pool, UntouchedVector<int>& array, int depth) {
+    std::unique_ptr<int[]> buffer = allocate_untouched<int>(array.size());
+    parallel_copy(pool, std::span<const int>(array), std::span<int>(buffer.get(), array.size()));
+    task_simd_pingpong_sort(pool, buffer.get(), array.data(), 0, array.size(), depth);
+}
 
 // Function to print only the first 20 elements of the vector
-void printVector(const std::vector<int>& v) {
+void printVector(const UntouchedVector<int>& v) {
     int elements = 0;
     for (int num : v) {
         if (elements<20) std::cout << num << " ";
@@ -166,26 +371,137 @@ void printVector(const std::vector<int>& v) {
 }
 
 
-int main() {
-    // Create a vector to store N random numbers
-    
-    std::vector<int> array(number_of_elements);
+// Out-of-core modes, for data sets larger than memory:
+//   PMS --generate-keys FILE COUNT                                 writes COUNT random int32 keys
+//   PMS --external-sort INPUT OUTPUT [--memory MB] [--temp DIR]    sorts a key file within MB megabytes
+// std::stoull, except that a negative number is rejected instead of wrapping around
+static unsigned long long parse_count(const std::string& text) {
+    if (text.find('-') != std::string::npos) throw std::invalid_argument(text);
+    return std::stoull(text);
+}
+
+int external_sort_main(int argc, char* argv[]) {
+    std::string mode = argv[1];
+    if ((mode != "--generate-keys" && mode != "--external-sort") || argc < 4) {
+        std::cerr << "Usage: PMS --generate-keys FILE COUNT | --external-sort INPUT OUTPUT [--memory MB] [--temp DIR]" << std::endl;
+        return 1;
+    }
+    try {
+        if (mode == "--generate-keys") {
+            generate_key_file(argv[2], parse_count(argv[3]), std::random_device()());
+            return 0;
+        }
+        ExternalSortConfig config;
+        config.input = argv[2];
+        config.output = argv[3];
+        for (int i = 4; i + 1 < argc; i += 2) {
+            std::string option = argv[i];
+            if (option == "--memory") {
+                unsigned long long megabytes = parse_count(argv[i + 1]);
+                if (megabytes > (SIZE_MAX >> 20)) throw std::out_of_range("--memory");
+                config.memory_budget = static_cast<size_t>(megabytes) << 20;
+            }
+            else if (option == "--temp") config.temp_dir = argv[i + 1];
+        }
+
+        WorkStealingPool pool;
+        ExternalSortStats stats = external_sort(pool, config);
+        std::cout << "Sorted " << stats.keys << " keys in " << stats.runs << " runs, " << stats.merge_passes
+            << " merge passes" << std::endl;
+        std::cout << "Run formation: " << stats.run_seconds << " s, merge: " << stats.merge_seconds << " s" << std::endl;
+    }
+    catch (const std::logic_error& e) { // parse_count(): not a number, negative or out of range
+        std::cerr << "Bad number in the arguments (" << e.what() << ")" << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "External sort failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Every sort variant of this file, for the benchmark suite (PMS --bench)
+std::vector<SortVariant> sort_variants() {
+    using Context = const SortContext&;
+    return {
+        // The sequential sorts split the same levels as the pool sorts, so that their phase profiles compare level by level
+        {"Sequential", false, [](UntouchedVector<int>& a, Context c) {
+            profiled_mergesort(a, 0, static_cast<int>(a.size()) - 1, c.task_depth); }},
+        {"Parallel", true, [](UntouchedVector<int>& a, Context c) {
+            partial_parallel_mergesort(a, 0, static_cast<int>(a.size()) - 1, c.thread_depth); }},
+        {"Task pool", true, [](UntouchedVector<int>& a, Context c) {
+            task_parallel_mergesort(c.pool, a, 0, static_cast<int>(a.size()) - 1, c.task_depth); }},
+        {"Sequential ping-pong", false, [](UntouchedVector<int>& a, Context c) { pingpong_mergesort(a, c.task_depth); }},
+        {"Task pool ping-pong", true, [](UntouchedVector<int>& a, Context c) { task_pingpong_mergesort(c.pool, a, c.task_depth); }},
+        {"Sequential SIMD", false, [](UntouchedVector<int>& a, Context c) { simd_pingpong_mergesort(a, c.task_depth); }},
+        {"Task pool SIMD", true, [](UntouchedVector<int>& a, Context c) { task_simd_pingpong_mergesort(c.pool, a, c.task_depth); }},
+        {"Generic stable", false, [](UntouchedVector<int>& a, Context) { stable_sort_range(a.begin(), a.end()); }},
+        {"Generic task pool", true, [](UntouchedVector<int>& a, Context c) { parallel_stable_sort_range(c.pool, a.begin(), a.end()); }},
+        {"Radix", true, [](UntouchedVector<int>& a, Context c) { radix_sort(c.pool, std::span<int32_t>(a)); }},
+        {"std::sort", false, [](UntouchedVector<int>& a, Context) { std::sort(a.begin(), a.end()); }},
+    };
+}
+
+// Runs the sequential and thread-per-split sorts, then every other variant. Names given on the command line (e.g.
+// PMS "Radix" "Task pool SIMD") select which of the other variants run; all of them sort the same data.
+// PMS --bench runs the benchmark suite instead (see bench_main() in sort_bench.h for its options).
+int main(int argc, char* argv[]) {
+    // --calibrate measures the tuning again even if the cache file fits this machine; the other arguments follow it.
+    bool recalibrate = argc > 1 && std::string(argv[1]) == "--calibrate";
+    if (recalibrate) {
+        argc--;
+        argv++;
+    }
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--generate-keys" || mode == "--external-sort") return external_sort_main(argc, argv);
+
+    // With LOCK_PROFILING, reports the pool's queue locks and cout_mutex once the pool has stopped (lock_profiler.h)
+    LockReportOnExit lock_report(std::cout);
+
+    // The pool is created once (hardware_concurrency() threads including this one) and could sort any number of batches.
+    // The tuning is measured with it the first time (or after --calibrate) and read from the cache file after that.
+    WorkStealingPool pool;
+    numThreads += pool.threads_created();
+    // The thread cutoff is measured with the sort partial_parallel_mergesort runs on its halves.
+    TuningParams tuning = load_or_calibrate(pool, TUNING_FILE, recalibrate, [](UntouchedVector<int>& a, size_t begin, size_t end) {
+        mergesort(a, static_cast<int>(begin), static_cast<int>(end) - 1);
+    });
+    THRESHOLD = static_cast<int>(std::min<size_t>(tuning.thread_cutoff, INT_MAX));
+    TASK_THRESHOLD = static_cast<int>(std::min<size_t>(tuning.sequential_cutoff, INT_MAX));
+    sort_leaf_size = tuning.leaf_size;
+    parallel_sort_grain = std::max<size_t>(tuning.sequential_cutoff, sort_leaf_size);
+    auto cutoff_text = [](int cutoff) { return cutoff == INT_MAX ? std::string("none") : std::to_string(cutoff); };
+    std::cout << "Tuning (" << TUNING_FILE << "): cutoff " << cutoff_text(TASK_THRESHOLD) << " (tasks), "
+        << cutoff_text(THRESHOLD) << " (threads), leaf " << sort_leaf_size
+        << ", L1 " << tuning.l1_cache / 1024 << " KB, L2 " << tuning.l2_cache / 1024 << " KB" << std::endl;
+
+    if (mode == "--bench") return bench_main(argc, argv, sort_variants(), tuning, numThreads);
+    if (mode.rfind("--", 0) == 0) {
+        std::cerr << "Usage: PMS [--calibrate] [variant names...] | --bench [options] | --generate-keys FILE COUNT"
+                     " | --external-sort INPUT OUTPUT [--memory MB] [--temp DIR]" << std::endl;
+        return 1;
+    }
+
+    // Create a vector to store N random numbers. Its elements are left unwritten (data_gen.h), so that the pool, not
+    // this thread, touches its pages first.
+    UntouchedVector<int> array(number_of_elements);
 
     // Initialize a random number generator
     std::random_device rd;               // Non-deterministic generator
-    std::mt19937 gen(rd());              // Standard mersenne_twister_engine seeded with rd()
-    std::uniform_int_distribution<> dis(1, number_of_elements); // INT_MAX); // Uniform distribution between 1 and N
+    uint64_t seed = rd();                // Seed of the counter-based generator (data_gen.h)
 
-    // Fill the vector with random numbers
-    for (int& number : array) {
-        number = dis(gen);
-    }
+    // Fill the vector with random numbers between 1 and N, in parallel on the pool. The same seed gives the same
+    // numbers whatever the number of threads.
+    generate_uniform(pool, array, seed, 1, static_cast<int>(number_of_elements)); // INT_MAX);
 
-    std::cout << "Size of the vector to be sorted : "<< number_of_elements << std::endl;
+    std::cout << "Size of the vector to be sorted : "<< number_of_elements << " (seed " << seed << ")" << std::endl;
 
     // Print the original, unsorted vector
     std::cout << "Original Vector:" << std::endl;
     printVector(array);
+    UntouchedVector<int> original(array.size()); // Every run below sorts a copy of the same input
+    parallel_copy(pool, std::span<const int>(array), std::span<int>(original));
 	// Measure the time taken by sequential mergesort
 	auto start = std::chrono::high_resolution_clock::now();
 	mergesort(array, 0, array.size() - 1);  // Perform standard mergesort on the entire array
@@ -196,11 +512,11 @@ int main() {
 	printVector(array);  // Print the sorted vector
 	std::cout << "Execution Time (Sequential): " << durationSeq << " nanoseconds" << std::endl;
 
-	// Shuffle array again to unsort it for parallel sort
-	std::shuffle(array.begin(), array.end(), gen);  // Shuffle using the same random number generator
+	// Restore the unsorted input for the parallel sort
+	array = original;
 
 	// Measure the time taken by parallel mergesort
-	int maxDepth = 2; // Define the depth of parallelism
+	int maxDepth = tuning.depth_for(array.size(), 1, tuning.thread_cutoff); // Define the depth of parallelism: about one leaf per thread
 	start = std::chrono::high_resolution_clock::now();
 
 	//parallel_mergesort(array, 0, array.size() - 1);  // Perform parallel mergesort on the entire array
@@ -218,6 +534,56 @@ int main() {
 	double speedup = static_cast<double>(durationSeq) / durationPar;
 	std::cout << "Speedup: " << speedup << "x" << std::endl;
 
+	// True if name was given on the command line, or if no names were given
+	auto selected = [&](const char* name) {
+		return argc == 1 || std::find(argv + 1, argv + argc, std::string(name)) != argv + argc;
+	};
+	// Restores the input, times one more sort variant and prints the result like the runs above.
+	auto timed_run = [&](const char* name, auto sort) {
+		if (!selected(name)) return;
+		array = original;
+		auto runStart = std::chrono::high_resolution_clock::now();
+		sort();
+		auto runEnd = std::chrono::high_resolution_clock::now();
+		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(runEnd - runStart).count();
+		std::cout << "Sorted Vector (" << name << "):" << std::endl;
+		printVector(array);
+		std::cout << "Execution Time (" << name << "): " << duration << " nanoseconds" << std::endl;
+		std::cout << "Speedup (" << name << "): " << static_cast<double>(durationSeq) / duration << "x" << std::endl;
+	};
+
+	// Same again with the tasks of the persistent work-stealing pool instead of new threads at every split.
+	int taskDepth = tuning.depth_for(array.size(), 4, tuning.sequential_cutoff); // Enough splits to give every thread of the pool several tasks to balance
+	timed_run("Task pool", [&] { task_parallel_mergesort(pool, array, 0, array.size() - 1, taskDepth); });
+
+	// Ping-pong buffers: one auxiliary buffer per sort instead of two new vectors in every merge.
+	timed_run("Sequential ping-pong", [&] { pingpong_mergesort(array); });
+	timed_run("Task pool ping-pong", [&] { task_pingpong_mergesort(pool, array, taskDepth); });
+
+	// SIMD kernels: 64-element blocks sorted in registers and vectorised merges, or branchless scalar code without AVX2.
+	std::cout << "SIMD kernels: " << (simd_available() ? "AVX2" : "scalar") << std::endl;
+	timed_run("Sequential SIMD", [&] { simd_pingpong_mergesort(array); });
+	timed_run("Task pool SIMD", [&] { task_simd_pingpong_mergesort(pool, array, taskDepth); });
+
+	// Generic interface (sort_api.h): size_t positions, any element type and comparator, stable.
+	timed_run("Generic stable", [&] { stable_sort_range(array.begin(), array.end()); });
+	timed_run("Generic task pool", [&] { parallel_stable_sort_range(pool, array.begin(), array.end()); });
+
+	// LSD radix sort: no comparisons, one pass over the data per byte of the key (skipped when all keys share it).
+	timed_run("Radix", [&] { radix_sort(pool, std::span<int32_t>(array)); });
+
+	// Key/value arrays: 64-bit keys (the values, descending) with the original positions as payload.
+	std::vector<uint64_t> keys(array.begin(), array.end());
+	std::vector<uint32_t> positions(array.size());
+	for (size_t i = 0; i < positions.size(); i++) positions[i] = static_cast<uint32_t>(i);
+	parallel_sort_by_key(pool, std::span<uint64_t>(keys), std::span<uint32_t>(positions), std::greater<>());
+	bool stable = true; // Positions of equal keys must still be in increasing order
+	for (size_t i = 1; i < keys.size(); i++) {
+		if (keys[i - 1] == keys[i] && positions[i - 1] > positions[i]) stable = false;
+	}
+	std::cout << "Key/value sort (descending keys): first key " << (keys.empty() ? 0 : keys[0])
+		<< ", equal keys in original order: " << (stable ? "yes" : "no") << std::endl;
+
  //-----------------------------------------------------------------------------------------------------
  // Print the number of CPU cores
 	unsigned int numCores = std::thread::hardware_concurrency();
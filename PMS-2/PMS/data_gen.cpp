@@ -0,0 +1,17 @@
+//
+// CMP202
+// Parallel, deterministic input generation and first-touch placement of large arrays
+//------------------------------------------------------------
+#include "data_gen.h"
+
+void generate_uniform(WorkStealingPool& pool, std::span<int> out, uint64_t seed, int low, int high) {
+    size_t n = out.size(), blocks = pool.size();
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+    pool.for_each_block(0, blocks, [&](size_t b) {
+        for (size_t i = block_begin(n, blocks, b), end = block_begin(n, blocks, b + 1); i < end; i++) {
+            // Top 32 bits scaled to the range by a multiply and shift (Lemire), without a division
+            uint64_t scaled = ((counter_random(seed, i) >> 32) * range) >> 32;
+            out[i] = static_cast<int>(low + static_cast<int64_t>(scaled));
+        }
+    });
+}
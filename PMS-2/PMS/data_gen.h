@@ -0,0 +1,84 @@
+//
+// CMP202
+// Parallel, deterministic input generation and first-touch placement of large arrays
+//------------------------------------------------------------
+#ifndef DATA_GEN_H
+#define DATA_GEN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "work_stealing_pool.h"
+
+// Operating systems place a page in the memory of the node whose thread writes it first. The helpers below therefore
+// leave new arrays untouched and fill them block by block on the pool, with the same one-block-per-thread partition as
+// the parallel sorts, so that each block starts out near the worker most likely to sort it. (Which worker sorts which
+// range is finally up to work stealing, so the placement is a good first guess, not a guarantee.)
+
+// Start of block b when n elements are split into blocks of nearly equal size
+inline size_t block_begin(size_t n, size_t blocks, size_t b) {
+    return n / blocks * b + std::min(b, n % blocks);
+}
+
+// Random number i of the stream seed (SplitMix64 of the counter). Every number depends only on (seed, i), so the
+// output is the same whichever thread generates which part, and for any number of threads.
+inline uint64_t counter_random(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// An array of n elements that is allocated but not written, so its pages are not placed yet (for trivial types;
+// other types are default-constructed by the calling thread).
+template <typename T>
+std::unique_ptr<T[]> allocate_untouched(size_t n) {
+    return std::unique_ptr<T[]>(new T[n]);
+}
+
+// Allocator that default-initialises the elements a vector creates instead of zeroing them, so that
+// UntouchedVector<T>(n) of a trivial type leaves its pages unplaced, like allocate_untouched(), until the pool fills it.
+template <typename T>
+struct DefaultInitAllocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        using other = DefaultInitAllocator<U>;
+    };
+    DefaultInitAllocator() = default;
+    template <typename U>
+    DefaultInitAllocator(const DefaultInitAllocator<U>&) noexcept {}
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T>
+using UntouchedVector = std::vector<T, DefaultInitAllocator<T>>;
+
+// Fills out with integers uniformly distributed in [low, high], block by block on the pool.
+void generate_uniform(WorkStealingPool& pool, std::span<int> out, uint64_t seed, int low, int high);
+
+// Copies src into dst (same size) block by block on the pool, so that dst is first touched by the workers.
+template <typename T>
+void parallel_copy(WorkStealingPool& pool, std::span<const T> src, std::span<T> dst) {
+    size_t n = src.size(), blocks = pool.size();
+    pool.for_each_block(0, blocks, [&](size_t b) {
+        std::copy(src.begin() + block_begin(n, blocks, b), src.begin() + block_begin(n, blocks, b + 1),
+                  dst.begin() + block_begin(n, blocks, b));
+    });
+}
+
+#endif
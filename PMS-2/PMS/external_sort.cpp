@@ -0,0 +1,293 @@
+//
+// CMP202
+// External (out-of-core) sort of binary key files: sorted runs within a memory budget, then a k-way loser-tree merge
+//------------------------------------------------------------
+#if defined(_WIN32)
+    #include <stdio.h>      // _getmaxstdio
+#else
+    #include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+
+#include "external_sort.h"
+#include "radix_sort.h"
+
+const size_t MIN_IO_KEYS = size_t(1) << 16; // Smallest read or write buffer (256 KB), to keep every transfer large
+const size_t RESERVED_FILES = 16;           // Open files left to the standard streams, the input and the output
+const int TEMP_NAME_ATTEMPTS = 100;         // Names tried before giving up on creating a temporary file
+
+// Closes the file when it goes out of scope. A file that was written must be closed with close_written() instead,
+// which reports what this cannot: a failed flush of the last buffer (e.g. when the disk is full).
+struct FileCloser {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+using File = std::unique_ptr<std::FILE, FileCloser>;
+
+static File open_file(const std::string& path, const char* mode) {
+    File file(std::fopen(path.c_str(), mode));
+    if (!file) throw std::runtime_error("cannot open " + path);
+    return file;
+}
+
+static void write_keys(std::FILE* file, const int32_t* keys, size_t count, const std::string& path) {
+    if (std::fwrite(keys, sizeof(int32_t), count, file) != count) throw std::runtime_error("cannot write " + path);
+}
+
+static void close_written(File& file, const std::string& path) {
+    std::FILE* f = file.release();
+    bool flushed = std::fflush(f) == 0;
+    bool closed = std::fclose(f) == 0;
+    if (!flushed || !closed) throw std::runtime_error("cannot write " + path);
+}
+
+// Reads as many keys as fit into keys (fewer only at the end of the file). Read byte by byte, so that a file whose
+// size is not a whole number of keys is rejected instead of losing its last bytes.
+static size_t read_keys(std::FILE* file, int32_t* keys, size_t count, const std::string& path) {
+    size_t bytes = std::fread(keys, 1, count * sizeof(int32_t), file);
+    if (bytes < count * sizeof(int32_t) && std::ferror(file)) throw std::runtime_error("cannot read " + path);
+    if (bytes % sizeof(int32_t) != 0) {
+        throw std::runtime_error(path + " is not a whole number of " + std::to_string(sizeof(int32_t)) + "-byte keys");
+    }
+    return bytes / sizeof(int32_t);
+}
+
+// Largest number of files the process may have open at once
+static size_t open_file_limit() {
+#if defined(_WIN32)
+    return static_cast<size_t>(_getmaxstdio());
+#else
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) return 1024;
+    return static_cast<size_t>(limit.rlim_cur);
+#endif
+}
+
+// The sorted runs of one sort. Every run gets a name of its own ("x" mode fails if the file exists, so two sorts
+// sharing temp_dir never write each other's runs), and whatever runs are left are deleted when the sort ends, whether
+// it finished or threw.
+class TempFiles {
+public:
+    explicit TempFiles(const std::string& dir) : dir(dir), tag(std::random_device()()) {}
+    ~TempFiles() {
+        for (const std::string& path : paths) std::remove(path.c_str());
+    }
+    TempFiles(const TempFiles&) = delete;
+    TempFiles& operator=(const TempFiles&) = delete;
+
+    // Creates a new, empty run file and opens it for writing
+    File create(std::string& path) {
+        for (int attempt = 0; attempt < TEMP_NAME_ATTEMPTS; attempt++) {
+            path = dir + "/pms_run_" + std::to_string(tag) + "_" + std::to_string(next++) + ".bin";
+            File file(std::fopen(path.c_str(), "wbx"));
+            if (file) {
+                paths.push_back(path);
+                return file;
+            }
+            tag = std::random_device()(); // Taken by another sort (or not writable): try another name
+        }
+        throw std::runtime_error("cannot create a temporary file in " + dir);
+    }
+
+    // Deletes a run once it has been merged
+    void remove(const std::string& path) {
+        std::remove(path.c_str());
+        paths.erase(std::find(paths.begin(), paths.end(), path));
+    }
+
+private:
+    std::string dir;
+    unsigned int tag;               // Random part of the names, so that each sort has its own
+    size_t next = 0;
+    std::vector<std::string> paths; // Created and not deleted yet
+};
+
+//------------------------------------------------------------
+// Loser tree
+
+LoserTree::LoserTree(size_t k) : k(k), tree(k, 0), heads(k, 0), live(k, 0) {}
+
+void LoserTree::set(size_t run, int32_t key, bool is_live) {
+    heads[run] = key;
+    live[run] = is_live;
+}
+
+bool LoserTree::less(size_t a, size_t b) const {
+    if (!live[a]) return false;
+    if (!live[b]) return true;
+    return heads[a] < heads[b] || (heads[a] == heads[b] && a < b);
+}
+
+void LoserTree::build() {
+    // Plays every match bottom-up: leaves are the nodes k .. 2k - 1, node n plays the winners of 2n and 2n + 1.
+    std::vector<size_t> winners(2 * k);
+    for (size_t i = 0; i < k; i++) winners[k + i] = i;
+    for (size_t node = k - 1; node >= 1; node--) {
+        size_t a = winners[2 * node], b = winners[2 * node + 1];
+        winners[node] = less(a, b) ? a : b;
+        tree[node] = less(a, b) ? b : a;
+    }
+    tree[0] = k > 1 ? winners[1] : 0;
+}
+
+void LoserTree::replace_top(int32_t key, bool is_live) {
+    size_t w = tree[0];
+    heads[w] = key;
+    live[w] = is_live;
+    for (size_t node = (w + k) / 2; node >= 1; node /= 2) {
+        if (less(tree[node], w)) std::swap(tree[node], w);
+    }
+    tree[0] = w;
+}
+
+//------------------------------------------------------------
+// Run input for the merge
+
+// Reads one sorted run through a large buffer
+class RunReader {
+public:
+    RunReader(const std::string& path, size_t buffer_keys) : path(path), file(open_file(path, "rb")), buffer(buffer_keys) {}
+
+    bool next(int32_t& key) {
+        if (position == count) {
+            count = read_keys(file.get(), buffer.data(), buffer.size(), path);
+            position = 0;
+            if (count == 0) return false;
+        }
+        key = buffer[position++];
+        return true;
+    }
+
+private:
+    std::string path;
+    File file;
+    std::vector<int32_t> buffer;
+    size_t position = 0, count = 0;
+};
+
+// Merges the sorted runs into output, with one read buffer per run and one for the output, buffer_keys keys each
+static void merge_run_files(const std::vector<std::string>& runs, std::FILE* output, const std::string& output_path,
+                            size_t buffer_keys) {
+    std::vector<std::unique_ptr<RunReader>> readers;
+    LoserTree tree(runs.size());
+    for (size_t i = 0; i < runs.size(); i++) {
+        readers.push_back(std::make_unique<RunReader>(runs[i], buffer_keys));
+        int32_t key = 0;
+        bool live = readers[i]->next(key);
+        tree.set(i, key, live);
+    }
+    tree.build();
+
+    std::vector<int32_t> out(buffer_keys);
+    size_t filled = 0;
+    while (!tree.empty()) {
+        out[filled++] = tree.top();
+        if (filled == out.size()) {
+            write_keys(output, out.data(), filled, output_path);
+            filled = 0;
+        }
+        int32_t key = 0;
+        bool live = readers[tree.winner()]->next(key);
+        tree.replace_top(key, live);
+    }
+    write_keys(output, out.data(), filled, output_path);
+}
+
+//------------------------------------------------------------
+
+ExternalSortStats external_sort(WorkStealingPool& pool, const ExternalSortConfig& config) {
+    ExternalSortStats stats;
+    auto start = std::chrono::steady_clock::now();
+    TempFiles temp(config.temp_dir); // Declared first, so that the runs are closed before they are deleted
+
+    // Run formation: half the budget holds the run, the other half is the radix sort's buffer.
+    size_t run_keys = std::max(MIN_IO_KEYS, config.memory_budget / (2 * sizeof(int32_t)));
+    std::vector<std::string> runs;
+    {
+        File input = open_file(config.input, "rb");
+        std::vector<int32_t> run(run_keys);
+        while (size_t count = read_keys(input.get(), run.data(), run.size(), config.input)) {
+            radix_sort(pool, std::span<int32_t>(run.data(), count));
+            stats.keys += count;
+
+            // A single run is the answer already: write it straight to the output.
+            if (runs.empty() && count < run.size()) {
+                File output = open_file(config.output, "wb");
+                write_keys(output.get(), run.data(), count, config.output);
+                close_written(output, config.output);
+                break;
+            }
+            std::string path;
+            File output = temp.create(path);
+            write_keys(output.get(), run.data(), count, path);
+            close_written(output, path);
+            runs.push_back(path);
+        }
+    }
+    if (stats.keys == 0) {                                  // Empty input: empty output
+        File output = open_file(config.output, "wb");
+        close_written(output, config.output);
+    }
+    auto merge_start = std::chrono::steady_clock::now();
+    stats.run_seconds = std::chrono::duration<double>(merge_start - start).count();
+    stats.runs = std::max<size_t>(runs.size(), stats.keys > 0 ? 1 : 0);
+    if (runs.empty()) return stats;
+
+    // Merge: the budget is shared by one read buffer per run and the output buffer, none of them smaller than
+    // MIN_IO_KEYS, and the runs must fit in the open-file limit. With more runs than that, groups of them are merged
+    // into longer runs, pass after pass, until one last merge into the output is left.
+    size_t files = open_file_limit();
+    size_t max_fan_in = std::min(config.memory_budget / (MIN_IO_KEYS * sizeof(int32_t)),
+                                 files > RESERVED_FILES ? files - RESERVED_FILES : 0);
+    max_fan_in = std::max<size_t>(max_fan_in, 3) - 1; // One buffer and one file are the output's
+    while (runs.size() > max_fan_in) {
+        std::vector<std::string> merged;
+        for (size_t first = 0; first < runs.size(); first += max_fan_in) {
+            std::vector<std::string> group(runs.begin() + first,
+                                           runs.begin() + std::min(runs.size(), first + max_fan_in));
+            if (group.size() == 1) {
+                merged.push_back(group[0]); // Nothing to merge it with in this pass
+                continue;
+            }
+            size_t buffer_keys = std::max(MIN_IO_KEYS, config.memory_budget / ((group.size() + 1) * sizeof(int32_t)));
+            std::string path;
+            {
+                File output = temp.create(path);
+                merge_run_files(group, output.get(), path, buffer_keys);
+                close_written(output, path);
+            }
+            for (const std::string& run : group) temp.remove(run);
+            merged.push_back(path);
+        }
+        runs = std::move(merged);
+        stats.merge_passes++;
+    }
+
+    size_t buffer_keys = std::max(MIN_IO_KEYS, config.memory_budget / ((runs.size() + 1) * sizeof(int32_t)));
+    {
+        File output = open_file(config.output, "wb");
+        merge_run_files(runs, output.get(), config.output, buffer_keys);
+        close_written(output, config.output);
+    }
+    stats.merge_passes++;
+    stats.merge_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - merge_start).count();
+    return stats;
+}
+
+void generate_key_file(const std::string& path, size_t count, uint64_t seed) {
+    File output = open_file(path, "wb");
+    std::mt19937_64 gen(seed);
+    std::vector<int32_t> keys(MIN_IO_KEYS);
+    for (size_t written = 0; written < count; written += keys.size()) {
+        size_t n = std::min(keys.size(), count - written);
+        for (size_t i = 0; i < n; i++) keys[i] = static_cast<int32_t>(gen());
+        write_keys(output.get(), keys.data(), n, path);
+    }
+    close_written(output, path);
+}
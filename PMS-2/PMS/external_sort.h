@@ -0,0 +1,69 @@
+//
+// CMP202
+// External (out-of-core) sort of binary key files: sorted runs within a memory budget, then a k-way loser-tree merge
+//------------------------------------------------------------
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "work_stealing_pool.h"
+
+// Files hold raw int32_t keys in the byte order of the machine, with no header.
+struct ExternalSortConfig {
+    std::string input;
+    std::string output;
+    std::string temp_dir = ".";                // Where the sorted runs are written (and deleted once merged)
+    size_t memory_budget = size_t(256) << 20;  // Bytes of keys held in memory at once, by run formation or merge
+};
+
+struct ExternalSortStats {
+    size_t keys = 0;
+    size_t runs = 0;
+    size_t merge_passes = 0;    // Passes over the data after run formation (the last one writes the output)
+    double run_seconds = 0;     // Reading, sorting and writing the runs
+    double merge_seconds = 0;
+};
+
+// Selects the smallest head among k sorted runs in O(log k) comparisons per key. Every internal node keeps the loser
+// of the match played there, so after the winner's run advances only the matches on its path to the root are
+// replayed, each against a stored loser (one comparison per level, unlike a heap's two).
+class LoserTree {
+public:
+    explicit LoserTree(size_t k);
+
+    // Sets the head of run i (or marks it exhausted) before build()
+    void set(size_t run, int32_t key, bool live);
+    void build();
+
+    size_t winner() const { return tree[0]; }
+    bool empty() const { return !live[tree[0]]; }
+    int32_t top() const { return heads[tree[0]]; }
+
+    // Replaces the head of the winning run with its next key, or marks it exhausted, and finds the new winner
+    void replace_top(int32_t key, bool live);
+
+private:
+    bool less(size_t a, size_t b) const; // Exhausted runs lose every match; ties go to the lower run
+
+    size_t k;
+    std::vector<size_t> tree;       // tree[0] is the winner, tree[1, k) the losers of the internal nodes
+    std::vector<int32_t> heads;
+    std::vector<char> live;
+};
+
+// Sorts config.input into config.output. Runs of up to memory_budget / 8 keys (the run plus the radix sort's buffer)
+// are read, sorted on the pool and written out one after another, then merged with one large read buffer per run. A
+// merge takes at most as many runs as the budget has 256 KB buffers and the process may open files (less one each for
+// the output); more runs are merged in several passes. Throws std::runtime_error if a file cannot be opened, read or
+// written (including a failed flush when a file is closed) or if the input is not a whole number of keys; the runs
+// written so far are deleted either way.
+ExternalSortStats external_sort(WorkStealingPool& pool, const ExternalSortConfig& config);
+
+// Writes count random keys to path, for trying out external_sort().
+void generate_key_file(const std::string& path, size_t count, uint64_t seed);
+
+#endif
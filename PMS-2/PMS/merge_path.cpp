@@ -0,0 +1,38 @@
+//
+// CMP202
+// Parallel merge by merge-path (co-rank) partitioning, on the work-stealing pool
+//------------------------------------------------------------
+#include <algorithm>
+
+#include "merge_path.h"
+#include "phase_profiler.h"
+#include "simd_sort.h"
+
+// Merges output chunks [first, last) of total, halving the range with fork_join() until there is one chunk per task.
+// Each chunk is counted as the phase the merge was started in, whichever thread runs it (phase_profiler.h).
+static void merge_chunks(WorkStealingPool& pool, const int* a, size_t na, const int* b, size_t nb, int* out,
+                         unsigned int first, unsigned int last, unsigned int total, PhaseTag phase) {
+    if (last - first > 1) {
+        unsigned int half = first + (last - first) / 2;
+        pool.fork_join([&] { merge_chunks(pool, a, na, b, nb, out, first, half, total, phase); },
+                       [&] { merge_chunks(pool, a, na, b, nb, out, half, last, total, phase); });
+        return;
+    }
+    PhaseScope counted(phase);
+    size_t n = na + nb;
+    size_t begin = n * first / total, end = n * last / total;
+    size_t i0 = co_rank(begin, a, na, b, nb), i1 = co_rank(end, a, na, b, nb);
+    size_t j0 = begin - i0, j1 = end - i1;
+    merge_sequences(a + i0, i1 - i0, b + j0, j1 - j0, out + begin);
+}
+
+void parallel_merge(WorkStealingPool& pool, const int* src, int* dst, size_t left, size_t mid, size_t right,
+                    unsigned int chunks) {
+    size_t n = right - left;
+    chunks = static_cast<unsigned int>(std::min<size_t>(chunks, n / MIN_MERGE_CHUNK));
+    if (chunks < 2) {
+        merge_runs(src, dst, left, mid, right);
+        return;
+    }
+    merge_chunks(pool, src + left, mid - left, src + mid, right - mid, dst + left, 0, chunks, chunks, current_phase());
+}
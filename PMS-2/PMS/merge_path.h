@@ -0,0 +1,39 @@
+//
+// CMP202
+// Parallel merge by merge-path (co-rank) partitioning, on the work-stealing pool
+//------------------------------------------------------------
+#ifndef MERGE_PATH_H
+#define MERGE_PATH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+
+#include "work_stealing_pool.h"
+
+// Smallest piece of a merge that parallel_merge() hands to a task of its own
+const size_t MIN_MERGE_CHUNK = 16384;
+
+// Co-rank of output position k when merging a[0, na) and b[0, nb): the number i of elements of a among the first k
+// outputs (the other k - i come from b). Binary search over the diagonal k of the merge path, O(log min(na, nb)).
+// Equal elements of a come before those of b, as in a stable merge.
+template <typename T, typename Compare = std::less<>>
+size_t co_rank(size_t k, const T* a, size_t na, const T* b, size_t nb, Compare comp = {}) {
+    size_t low = k > nb ? k - nb : 0;
+    size_t high = std::min(k, na);
+    // !(b[k - i - 1] < a[i]) means a[i] belongs before the split, so i is too small; this is true for small i and
+    // false from the answer onwards.
+    while (low < high) {
+        size_t i = low + (high - low) / 2;
+        if (!comp(b[k - i - 1], a[i])) low = i + 1;
+        else high = i;
+    }
+    return low;
+}
+
+// Merges the sorted runs src[left, mid) and src[mid, right) into dst[left, right) like merge_runs(), but splits the
+// output into up to chunks equal parts, each found by co_rank() and merged independently as a task of the pool.
+void parallel_merge(WorkStealingPool& pool, const int* src, int* dst, size_t left, size_t mid, size_t right,
+                    unsigned int chunks);
+
+#endif
@@ -0,0 +1,306 @@
+//
+// CMP202
+// Hardware performance counters per sort phase and per thread (Linux perf_event_open), with a fallback to phase times
+//------------------------------------------------------------
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "phase_profiler.h"
+
+void PhaseCounters::add(const PhaseCounters& other) {
+    auto sum = [](int64_t& a, int64_t b) { a = a < 0 || b < 0 ? -1 : a + b; };
+    ms += other.ms;
+    sum(cycles, other.cycles);
+    sum(instructions, other.instructions);
+    sum(llc_misses, other.llc_misses);
+    sum(branch_misses, other.branch_misses);
+    sum(context_switches, other.context_switches);
+}
+
+std::vector<PhaseSample> PhaseProfile::by_phase() const {
+    std::vector<PhaseSample> phases;
+    for (const PhaseSample& sample : samples) {
+        if (phases.empty() || phases.back().phase != sample.phase) phases.push_back({sample.phase, 0, {}});
+        phases.back().thread++;
+        phases.back().counters.add(sample.counters);
+    }
+    return phases;
+}
+
+PhaseCounters PhaseProfile::total() const {
+    PhaseCounters total;
+    for (const PhaseSample& sample : samples) total.add(sample.counters);
+    return total;
+}
+
+namespace phase_profiler_detail {
+std::atomic<bool> active{false};
+}
+
+namespace {
+
+enum Counter { CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, CONTEXT_SWITCHES, COUNTERS };
+const char* const COUNTER_NAMES[COUNTERS] = {"cycles", "instructions", "LLC misses", "branch misses",
+                                             "context switches"};
+
+struct Reading {
+    std::chrono::steady_clock::time_point time;
+    int64_t value[COUNTERS];
+};
+
+// The phases one thread has counted in the current profile. Only that thread writes it, and only between
+// begin_phase_profile() and end_phase_profile().
+struct ThreadTable {
+    std::map<int, PhaseCounters> phases;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTable>> tables;   // Also held by their threads, until they exit
+    std::string status;                                 // Set by the first thread that opens its counters
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+#if defined(__linux__)
+// A counter of the calling thread only, on whichever CPU it runs. Returns -1 and sets error if it cannot be opened.
+int open_counter(uint32_t type, uint64_t config, bool user_only, int& error) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = user_only ? 1 : 0;     // User space only works with perf_event_paranoid up to 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (fd < 0) error = errno;
+    return fd;
+}
+
+// Scaled up by the share of time the counter was on the PMU, when the kernel had to multiplex more counters than it has
+int64_t read_counter(int fd) {
+    uint64_t values[3];                         // Value, time enabled, time running
+    if (read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) return -1;
+    if (values[2] == 0) return 0;
+    if (values[2] >= values[1]) return static_cast<int64_t>(values[0]);
+    return static_cast<int64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+}
+#endif
+
+// The counters of one thread, opened the first time it enters a phase
+class ThreadCounters {
+public:
+    ThreadCounters() : table(std::make_shared<ThreadTable>()) {
+        std::fill(std::begin(fd), std::end(fd), -1);
+        std::string unavailable;
+#if defined(__linux__)
+        const uint64_t hardware[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+                                     PERF_COUNT_HW_BRANCH_MISSES};
+        int error = 0, software_error = 0;
+        for (int c = CYCLES; c <= BRANCH_MISSES; c++) {
+            fd[c] = open_counter(PERF_TYPE_HARDWARE, hardware[c], true, error);
+        }
+        fd[CONTEXT_SWITCHES] = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false, software_error);
+        for (int c = CYCLES; c <= BRANCH_MISSES; c++) {
+            if (fd[c] < 0) unavailable += std::string(unavailable.empty() ? "" : ", ") + COUNTER_NAMES[c];
+        }
+        if (!unavailable.empty()) {
+            unavailable += " not available (perf_event_open: " + std::string(std::strerror(error)) + ")";
+        }
+        if (fd[CONTEXT_SWITCHES] < 0) {
+            unavailable += std::string(unavailable.empty() ? "" : "; ") + "context switches from getrusage";
+        }
+#else
+        unavailable = "hardware counters need Linux perf_event_open; phase times only";
+#endif
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.tables.push_back(table);
+        if (r.status.empty()) r.status = unavailable.empty() ? "all counters available" : unavailable;
+    }
+
+    ~ThreadCounters() {
+#if defined(__linux__)
+        for (int f : fd) {
+            if (f >= 0) close(f);
+        }
+#endif
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    Reading read() const {
+        Reading reading;
+        reading.time = std::chrono::steady_clock::now();
+        for (int c = 0; c < COUNTERS; c++) reading.value[c] = -1;
+#if defined(__linux__)
+        for (int c = 0; c < COUNTERS; c++) {
+            if (fd[c] >= 0) reading.value[c] = read_counter(fd[c]);
+        }
+        if (fd[CONTEXT_SWITCHES] < 0) {
+            struct rusage usage;
+            if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+                reading.value[CONTEXT_SWITCHES] = usage.ru_nvcsw + usage.ru_nivcsw;
+            }
+        }
+#endif
+        return reading;
+    }
+
+    // Adds what happened since the last reading to the phase on top of the stack
+    void count(const Reading& now) {
+        if (stack.empty()) return;
+        PhaseCounters delta;
+        delta.ms = std::chrono::duration<double, std::milli>(now.time - last.time).count();
+        int64_t* fields[COUNTERS] = {&delta.cycles, &delta.instructions, &delta.llc_misses, &delta.branch_misses,
+                                     &delta.context_switches};
+        for (int c = 0; c < COUNTERS; c++) {
+            *fields[c] = now.value[c] < 0 || last.value[c] < 0 ? -1 : now.value[c] - last.value[c];
+        }
+        table->phases[stack.back()].add(delta);
+    }
+
+    std::shared_ptr<ThreadTable> table;
+    std::vector<int> stack;                 // Keys of the phases this thread is in, innermost last
+    Reading last{};
+
+private:
+    int fd[COUNTERS];
+};
+
+ThreadCounters& thread_counters() {
+    registry(); // Constructed first, so that it outlives every thread's counters
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+std::string phase_name(int key) {
+    if (key == static_cast<int>(Phase::DataGeneration)) return "data generation";
+    if (key == static_cast<int>(Phase::Sort)) return "sort (other)";
+    if (key == static_cast<int>(Phase::LeafSort)) return "leaf sorts";
+    int level = key - static_cast<int>(Phase::Merge);
+    return level == 0 ? "final merge" : "merge level " + std::to_string(level);
+}
+
+// Where a phase goes in the tables: the merges come last, from the deepest level up to the final merge
+int phase_order(int key) {
+    int merge = static_cast<int>(Phase::Merge);
+    return key < merge ? key : std::numeric_limits<int>::max() - (key - merge);
+}
+
+std::string count_text(int64_t value) {
+    return value < 0 ? "n/a" : std::to_string(value);
+}
+
+} // namespace
+
+namespace phase_profiler_detail {
+
+void enter(int key) {
+    ThreadCounters& counters = thread_counters();
+    Reading now = counters.read();
+    counters.count(now);
+    counters.stack.push_back(key);
+    counters.last = now;
+}
+
+void leave() {
+    ThreadCounters& counters = thread_counters();
+    Reading now = counters.read();
+    counters.count(now);
+    counters.stack.pop_back();
+    counters.last = now;
+}
+
+PhaseTag current() {
+    ThreadCounters& counters = thread_counters();
+    return counters.stack.empty() ? PhaseTag{} : PhaseTag{counters.stack.back()};
+}
+
+} // namespace phase_profiler_detail
+
+void begin_phase_profile() {
+    thread_counters();
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        // Drop the tables of threads that have exited (the thread-per-split sorts start new threads every run)
+        r.tables.erase(std::remove_if(r.tables.begin(), r.tables.end(),
+                                      [](const std::shared_ptr<ThreadTable>& table) { return table.use_count() == 1; }),
+                       r.tables.end());
+        for (const std::shared_ptr<ThreadTable>& table : r.tables) table->phases.clear();
+    }
+    phase_profiler_detail::active.store(true);
+}
+
+PhaseProfile end_phase_profile() {
+    phase_profiler_detail::active.store(false);
+    std::shared_ptr<ThreadTable> own = thread_counters().table;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    // This thread first, then the others that counted anything, in the order they first counted
+    std::vector<ThreadTable*> tables{own.get()};
+    for (const std::shared_ptr<ThreadTable>& table : r.tables) {
+        if (table != own && !table->phases.empty()) tables.push_back(table.get());
+    }
+    struct Keyed {
+        int key;
+        PhaseSample sample;
+    };
+    std::vector<Keyed> keyed;
+    for (size_t t = 0; t < tables.size(); t++) {
+        for (const auto& [key, counters] : tables[t]->phases) {
+            keyed.push_back({key, {phase_name(key), static_cast<unsigned int>(t), counters}});
+        }
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const Keyed& a, const Keyed& b) {
+        return phase_order(a.key) < phase_order(b.key);
+    });
+    PhaseProfile profile;
+    for (const Keyed& k : keyed) profile.samples.push_back(k.sample);
+    return profile;
+}
+
+std::string phase_counter_status() {
+    thread_counters();
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.status;
+}
+
+void print_phase_profile(std::ostream& out, const PhaseProfile& profile) {
+    out << "    " << std::left << std::setw(16) << "phase" << std::right << std::setw(8) << "threads" << std::setw(12)
+        << "thread ms" << std::setw(15) << "cycles" << std::setw(6) << "IPC" << std::setw(13) << "LLC misses"
+        << std::setw(14) << "branch misses" << std::setw(10) << "ctx sw" << "\n";
+    for (const PhaseSample& phase : profile.by_phase()) {
+        const PhaseCounters& c = phase.counters;
+        out << "    " << std::left << std::setw(16) << phase.phase << std::right << std::setw(8) << phase.thread
+            << std::setw(12) << std::fixed << std::setprecision(3) << c.ms << std::setw(15) << count_text(c.cycles)
+            << std::setw(6) << std::setprecision(2);
+        if (c.cycles > 0 && c.instructions >= 0) out << c.ipc();
+        else out << "n/a";
+        out << std::setw(13) << count_text(c.llc_misses) << std::setw(14) << count_text(c.branch_misses)
+            << std::setw(10) << count_text(c.context_switches) << std::defaultfloat << std::setprecision(6) << "\n";
+    }
+}
@@ -0,0 +1,100 @@
+//
+// CMP202
+// Hardware performance counters per sort phase and per thread (Linux perf_event_open), with a fallback to phase times
+//------------------------------------------------------------
+#ifndef PHASE_PROFILER_H
+#define PHASE_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Phases of a divide-and-conquer sort. Merges are told apart by their level, counted from the top of the recursion:
+// 0 is the final merge, 1 the two merges that feed it, and so on.
+enum class Phase { DataGeneration, Sort, LeafSort, Merge };
+
+// Counts of one phase (on one thread, or summed). -1: the counter is not available on this machine.
+struct PhaseCounters {
+    double ms = 0;
+    int64_t cycles = 0;
+    int64_t instructions = 0;
+    int64_t llc_misses = 0;         // Cache misses as the kernel defines them: usually last-level cache misses
+    int64_t branch_misses = 0;
+    int64_t context_switches = 0;
+
+    void add(const PhaseCounters& other);
+    double ipc() const { return cycles > 0 && instructions >= 0 ? static_cast<double>(instructions) / cycles : 0; }
+};
+
+struct PhaseSample {
+    std::string phase;              // "data generation", "sort (other)" (includes waiting for the other threads),
+                                    // "leaf sorts", "merge level N" (N levels below the final merge), "final merge"
+    unsigned int thread = 0;        // 0 is the thread that ran the profile; the others are numbered as they first count
+    PhaseCounters counters;
+};
+
+// One profiled run: a sample for every phase every thread took part in, in phase order (the merges from the deepest
+// level up to the final merge), then thread order
+struct PhaseProfile {
+    std::vector<PhaseSample> samples;
+
+    std::vector<PhaseSample> by_phase() const;  // Summed over the threads (thread is then the number of threads)
+    PhaseCounters total() const;
+};
+
+// A phase as it is passed to a task that continues it on another thread; key -1 is no phase
+struct PhaseTag {
+    int key = -1;
+};
+
+namespace phase_profiler_detail {
+extern std::atomic<bool> active;
+void enter(int key);
+void leave();
+PhaseTag current();
+}
+
+// The innermost phase of the calling thread while a profile is being taken, else no phase
+inline PhaseTag current_phase() {
+    if (!phase_profiler_detail::active.load(std::memory_order_relaxed)) return {};
+    return phase_profiler_detail::current();
+}
+
+// Counts the enclosing block as the given phase on this thread while a profile is being taken, and does nothing
+// otherwise. Counting is exclusive: a scope opened inside another (a thread that steals a leaf sort while it waits in
+// a merge) takes its counts away from the outer one. Work outside every scope is not counted.
+class PhaseScope {
+public:
+    explicit PhaseScope(Phase phase, int level = 0)
+        : counting(phase_profiler_detail::active.load(std::memory_order_relaxed)) {
+        if (counting) phase_profiler_detail::enter(static_cast<int>(phase) + (phase == Phase::Merge ? level : 0));
+    }
+    // Counts the block as the phase of the code that forked this task
+    explicit PhaseScope(PhaseTag tag)
+        : counting(tag.key >= 0 && phase_profiler_detail::active.load(std::memory_order_relaxed)) {
+        if (counting) phase_profiler_detail::enter(tag.key);
+    }
+    ~PhaseScope() {
+        if (counting) phase_profiler_detail::leave();
+    }
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+    bool counting;
+};
+
+// Starts a profile. Every thread that runs a PhaseScope until end_phase_profile() is counted; the threads must not be
+// inside a PhaseScope at either call (between sorts, pool workers are idle).
+void begin_phase_profile();
+PhaseProfile end_phase_profile();
+
+// Which counters this machine provides, and why the others are missing (e.g. perf_event_paranoid, or no PMU in a VM)
+std::string phase_counter_status();
+
+// Per-phase table of a profile, summed over the threads
+void print_phase_profile(std::ostream& out, const PhaseProfile& profile);
+
+#endif
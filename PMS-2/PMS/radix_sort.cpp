@@ -0,0 +1,112 @@
+//
+// CMP202
+// Parallel LSD radix sort for 32- and 64-bit integer keys, on the work-stealing pool
+//------------------------------------------------------------
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "data_gen.h"
+#include "radix_sort.h"
+
+const int RADIX_BITS = 8;
+const size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+const size_t RADIX_MIN_BLOCK = 65536;   // Smaller blocks cost more in histograms and prefix sums than they gain
+
+using Histogram = std::array<size_t, RADIX_BUCKETS>;
+
+// Digit of key for the pass that starts at bit shift, with the sign bit flipped for signed keys so that negative
+// numbers come first.
+template <typename K>
+static inline size_t digit(K key, int shift) {
+    using U = std::make_unsigned_t<K>;
+    U bits = static_cast<U>(key);
+    if constexpr (std::is_signed_v<K>) bits ^= U(1) << (sizeof(K) * 8 - 1);
+    return static_cast<size_t>(bits >> shift) & (RADIX_BUCKETS - 1);
+}
+
+// Scatters src[begin, end) into dst by the digit at shift, starting at the positions in next. The keys of each digit
+// are gathered in a cache-line-sized buffer and copied out a line at a time, which keeps the 256 output streams from
+// evicting each other and avoids reading the destination lines before writing them. Each buffer is filled at the same
+// offset within its line as the destination position, so every copy but the first and last of a digit is one whole,
+// aligned cache line.
+template <typename K>
+static void scatter_block(const K* src, K* dst, size_t begin, size_t end, int shift, Histogram& next) {
+    const size_t LINE = 64 / sizeof(K);
+    alignas(64) K buffer[RADIX_BUCKETS][64 / sizeof(K)];
+    std::array<unsigned char, RADIX_BUCKETS> start;     // First slot in use: where next[d] falls within its line
+    std::array<unsigned char, RADIX_BUCKETS> fill;      // One past the last slot in use
+    for (size_t d = 0; d < RADIX_BUCKETS; d++) {
+        start[d] = fill[d] = static_cast<unsigned char>(reinterpret_cast<uintptr_t>(dst + next[d]) % 64 / sizeof(K));
+    }
+
+    for (size_t i = begin; i < end; i++) {
+        K key = src[i];
+        size_t d = digit(key, shift);
+        buffer[d][fill[d]++] = key;
+        if (fill[d] == LINE) {
+            std::memcpy(dst + next[d], buffer[d] + start[d], (LINE - start[d]) * sizeof(K));
+            next[d] += LINE - start[d];
+            start[d] = fill[d] = 0;
+        }
+    }
+    for (size_t d = 0; d < RADIX_BUCKETS; d++) {
+        std::memcpy(dst + next[d], buffer[d] + start[d], (fill[d] - start[d]) * sizeof(K));
+    }
+}
+
+template <typename K>
+static void radix_sort_keys(WorkStealingPool& pool, std::span<K> keys) {
+    size_t n = keys.size();
+    if (n < 2) return;
+    size_t blocks = std::clamp<size_t>(n / RADIX_MIN_BLOCK, 1, pool.size());
+
+    std::unique_ptr<K[]> buffer = allocate_untouched<K>(n);  // First written by the scatter of the first pass
+    K* src = keys.data();
+    K* dst = buffer.get();
+    std::vector<Histogram> counts(blocks);
+
+    for (int shift = 0; shift < static_cast<int>(sizeof(K) * 8); shift += RADIX_BITS) {
+        // Every block counts its own digits, so the blocks never share a counter.
+        pool.for_each_block(0, blocks, [&](size_t b) {
+            Histogram& count = counts[b];
+            count.fill(0);
+            for (size_t i = block_begin(n, blocks, b), end = block_begin(n, blocks, b + 1); i < end; i++) {
+                count[digit(src[i], shift)]++;
+            }
+        });
+
+        // All keys with the same digit: this pass would not move anything.
+        Histogram total{};
+        for (const Histogram& count : counts) {
+            for (size_t d = 0; d < RADIX_BUCKETS; d++) total[d] += count[d];
+        }
+        if (std::find(total.begin(), total.end(), n) != total.end()) continue;
+
+        // Exclusive prefix sum in digit-major, block-minor order: block b writes digit d after every key with a
+        // smaller digit and after the keys with digit d of blocks before it, which keeps the sort stable.
+        size_t position = 0;
+        for (size_t d = 0; d < RADIX_BUCKETS; d++) {
+            for (size_t b = 0; b < blocks; b++) {
+                size_t count = counts[b][d];
+                counts[b][d] = position;
+                position += count;
+            }
+        }
+
+        pool.for_each_block(0, blocks, [&](size_t b) {
+            scatter_block(src, dst, block_begin(n, blocks, b), block_begin(n, blocks, b + 1), shift, counts[b]);
+        });
+        std::swap(src, dst);
+    }
+
+    // An odd number of passes ran: the sorted keys are in the buffer.
+    if (src != keys.data()) std::copy(src, src + n, keys.data());
+}
+
+void radix_sort(WorkStealingPool& pool, std::span<int32_t> keys) { radix_sort_keys(pool, keys); }
+void radix_sort(WorkStealingPool& pool, std::span<uint32_t> keys) { radix_sort_keys(pool, keys); }
+void radix_sort(WorkStealingPool& pool, std::span<int64_t> keys) { radix_sort_keys(pool, keys); }
+void radix_sort(WorkStealingPool& pool, std::span<uint64_t> keys) { radix_sort_keys(pool, keys); }
@@ -0,0 +1,24 @@
+//
+// CMP202
+// Parallel LSD radix sort for 32- and 64-bit integer keys, on the work-stealing pool
+//------------------------------------------------------------
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <cstdint>
+#include <span>
+
+#include "work_stealing_pool.h"
+
+// Sorts the keys into ascending order, one byte of the key per pass (least significant first). Every pass splits the
+// array into one block per thread of the pool; each block counts its digits into its own histogram, a prefix sum over
+// all histograms gives every block its own output positions, and each block then scatters its keys through small
+// write-combining buffers that are flushed a whole, aligned cache line at a time (only the first and last flush of
+// each digit in a block can be partial lines). Passes in which all keys share the same digit are skipped. Signed keys
+// are sorted by flipping the sign bit of the top byte.
+void radix_sort(WorkStealingPool& pool, std::span<int32_t> keys);
+void radix_sort(WorkStealingPool& pool, std::span<uint32_t> keys);
+void radix_sort(WorkStealingPool& pool, std::span<int64_t> keys);
+void radix_sort(WorkStealingPool& pool, std::span<uint64_t> keys);
+
+#endif
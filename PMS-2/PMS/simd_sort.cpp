@@ -0,0 +1,216 @@
+//
+// CMP202
+// Sorting kernels: small-block sort and run merge, with AVX2 versions chosen at run time and scalar fallbacks
+//------------------------------------------------------------
+#include <algorithm>
+#include <climits>
+
+#include "simd_sort.h"
+
+// Define PMS_NO_SIMD to build only the scalar kernels (for comparison, or for compilers without the intrinsics)
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) && !defined(PMS_NO_SIMD)
+    #define PMS_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define PMS_TARGET_AVX2                                  // MSVC compiles AVX2 intrinsics without a flag
+    #else
+        #include <cpuid.h>
+        #define PMS_TARGET_AVX2 __attribute__((target("avx2")))   // Only these functions may use AVX2 instructions
+    #endif
+#endif
+
+//------------------------------------------------------------
+// Scalar fallbacks
+
+static void insertion_sort(int* data, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        int value = data[i];
+        size_t j = i;
+        while (j > 0 && data[j - 1] > value) {
+            data[j] = data[j - 1];
+            j--;
+        }
+        data[j] = value;
+    }
+}
+
+static void merge_sequences_scalar(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        int x = a[i], y = b[j];
+        bool take_a = x <= y;               // Used as a number below, so the compiler emits no jump for it
+        out[k++] = take_a ? x : y;
+        i += take_a;
+        j += !take_a;
+    }
+    while (i < na) out[k++] = a[i++];
+    while (j < nb) out[k++] = b[j++];
+}
+
+//------------------------------------------------------------
+// AVX2 kernels
+
+#ifdef PMS_X86
+
+// Sorts a bitonic sequence of 8 in one register: three half-cleaner stages (distance 4, 2, 1).
+PMS_TARGET_AVX2 static inline __m256i bitonic_clean8(__m256i v) {
+    __m256i p = _mm256_permute2x128_si256(v, v, 1);
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xF0);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xCC);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xAA);
+    return v;
+}
+
+// Merges two sorted registers: lo gets the 8 smallest elements, hi the 8 largest, both sorted.
+PMS_TARGET_AVX2 static inline void bitonic_merge8(__m256i a, __m256i b, __m256i& lo, __m256i& hi) {
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    b = _mm256_permutevar8x32_epi32(b, reverse);      // a ascending + b descending is a bitonic sequence of 16
+    lo = bitonic_clean8(_mm256_min_epi32(a, b));
+    hi = bitonic_clean8(_mm256_max_epi32(a, b));
+}
+
+PMS_TARGET_AVX2 static inline void compare_swap(__m256i& a, __m256i& b) {
+    __m256i mn = _mm256_min_epi32(a, b);
+    b = _mm256_max_epi32(a, b);
+    a = mn;
+}
+
+PMS_TARGET_AVX2 static void merge_sequences_avx2(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    if (na < 8 || nb < 8) {
+        merge_sequences_scalar(a, na, b, nb, out);
+        return;
+    }
+    size_t i = 8, j = 8, k = 0;
+    __m256i lo, carry;
+    bitonic_merge8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)),
+                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)), lo, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), lo);
+    k += 8;
+
+    // The next 8 come from the run with the smaller head; everything stored so far is <= everything not yet stored.
+    while (i + 8 <= na && j + 8 <= nb) {
+        const int* next;
+        if (a[i] <= b[j]) { next = a + i; i += 8; }
+        else { next = b + j; j += 8; }
+        bitonic_merge8(carry, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(next)), lo, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), lo);
+        k += 8;
+    }
+
+    // Fewer than 8 left in one of the runs: finish with a scalar three-way merge of the carry and both tails.
+    alignas(32) int rest[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(rest), carry);
+    size_t c = 0;
+    while (c < 8 || i < na || j < nb) {
+        if (c < 8 && (i >= na || rest[c] <= a[i]) && (j >= nb || rest[c] <= b[j])) out[k++] = rest[c++];
+        else if (i < na && (j >= nb || a[i] <= b[j])) out[k++] = a[i++];
+        else out[k++] = b[j++];
+    }
+}
+
+PMS_TARGET_AVX2 static void sort_small_block_avx2(int* data, size_t n) {
+    // Pads the block to 64 with INT_MAX, which sorts to the end and is cut off again.
+    alignas(32) int block[SIMD_BLOCK];
+    alignas(32) int other[SIMD_BLOCK];
+    std::copy(data, data + n, block);
+    std::fill(block + n, block + SIMD_BLOCK, INT_MAX);
+
+    __m256i r[8];
+    for (int i = 0; i < 8; i++) r[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(block + 8 * i));
+
+    // Optimal 19-comparator sorting network for 8 inputs, applied to all 8 columns at once.
+    compare_swap(r[0], r[2]); compare_swap(r[1], r[3]); compare_swap(r[4], r[6]); compare_swap(r[5], r[7]);
+    compare_swap(r[0], r[4]); compare_swap(r[1], r[5]); compare_swap(r[2], r[6]); compare_swap(r[3], r[7]);
+    compare_swap(r[0], r[1]); compare_swap(r[2], r[3]); compare_swap(r[4], r[5]); compare_swap(r[6], r[7]);
+    compare_swap(r[2], r[4]); compare_swap(r[3], r[5]);
+    compare_swap(r[1], r[4]); compare_swap(r[3], r[6]);
+    compare_swap(r[1], r[2]); compare_swap(r[3], r[4]); compare_swap(r[5], r[6]);
+
+    // Transposes the 8x8 block, so that every register holds one sorted column.
+    __m256i t[8], u[8];
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int i = 0; i < 4; i++) {
+        r[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+        r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+    }
+
+    // Merges the 8 sorted runs of 8 into runs of 16 in registers, then into 32 and 64 with the vector merge.
+    for (int i = 0; i < 8; i += 2) {
+        __m256i lo, hi;
+        bitonic_merge8(r[i], r[i + 1], lo, hi);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block + 8 * i), lo);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block + 8 * i + 8), hi);
+    }
+    merge_sequences_avx2(block, 16, block + 16, 16, other);
+    merge_sequences_avx2(block + 32, 16, block + 48, 16, other + 32);
+    merge_sequences_avx2(other, 32, other + 32, 32, block);
+
+    std::copy(block, block + n, data);
+}
+
+// True if the CPU has AVX2 and the operating system saves the AVX registers on a context switch.
+static bool detect_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // PMS_X86
+
+//------------------------------------------------------------
+// Run-time dispatch: the kernels are chosen once, the first time they are needed
+
+bool simd_available() {
+#ifdef PMS_X86
+    static const bool available = detect_avx2();
+    return available;
+#else
+    return false;
+#endif
+}
+
+void sort_small_block(int* data, size_t n) {
+#ifdef PMS_X86
+    if (n > 8 && simd_available()) {
+        sort_small_block_avx2(data, n);
+        return;
+    }
+#endif
+    insertion_sort(data, n);
+}
+
+void merge_sequences(const int* a, size_t na, const int* b, size_t nb, int* out) {
+#ifdef PMS_X86
+    if (simd_available()) {
+        merge_sequences_avx2(a, na, b, nb, out);
+        return;
+    }
+#endif
+    merge_sequences_scalar(a, na, b, nb, out);
+}
+
+void merge_runs(const int* src, int* dst, size_t left, size_t mid, size_t right) {
+    merge_sequences(src + left, mid - left, src + mid, right - mid, dst + left);
+}
@@ -0,0 +1,28 @@
+//
+// CMP202
+// Sorting kernels: small-block sort and run merge, with AVX2 versions chosen at run time and scalar fallbacks
+//------------------------------------------------------------
+#ifndef SIMD_SORT_H
+#define SIMD_SORT_H
+
+#include <cstddef>
+
+// Largest block sort_small_block() sorts in one go (an 8x8 block of AVX2 registers)
+const size_t SIMD_BLOCK = 64;
+
+// True if this CPU (and operating system) supports AVX2, so that the vector kernels are used.
+bool simd_available();
+
+// Sorts data[0, n) for n <= SIMD_BLOCK. AVX2: a sorting network across 8 registers, a transpose, and bitonic merges.
+// Fallback: insertion sort.
+void sort_small_block(int* data, size_t n);
+
+// Merges the sorted sequences a[0, na) and b[0, nb) into out[0, na + nb). AVX2: a bitonic merge
+// network that merges 8 elements at a time, so there is one (well predicted) branch per 8 elements.
+// Fallback: a branchless scalar merge, where the comparison selects with conditional moves instead of jumping.
+void merge_sequences(const int* a, size_t na, const int* b, size_t nb, int* out);
+
+// Merges the sorted runs src[left, mid) and src[mid, right) into dst[left, right) with merge_sequences().
+void merge_runs(const int* src, int* dst, size_t left, size_t mid, size_t right);
+
+#endif
@@ -0,0 +1,186 @@
+//
+// CMP202
+// Generic sort interface: any element type and comparator, size_t indexing, key/value arrays
+//------------------------------------------------------------
+#ifndef SORT_API_H
+#define SORT_API_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "data_gen.h"
+#include "merge_path.h"
+#include "work_stealing_pool.h"
+
+// Ranges of up to this many elements are sorted by insertion sort instead of being split further (set by tuning.h)
+inline size_t sort_leaf_size = 32;
+
+// Smallest range the parallel sort splits into two tasks (set by tuning.h)
+inline size_t parallel_sort_grain = 32768;
+
+// The building blocks below work on raw pointers and size_t positions, so a range can hold more than 2^31 elements.
+// Every step keeps equal elements in their original order, which makes the sorts stable.
+
+// Stable insertion sort of data[0, n).
+template <typename T, typename Compare>
+void insertion_sort_range(T* data, size_t n, Compare& comp) {
+    for (size_t i = 1; i < n; i++) {
+        T value = std::move(data[i]);
+        size_t j = i;
+        while (j > 0 && comp(value, data[j - 1])) {
+            data[j] = std::move(data[j - 1]);
+            j--;
+        }
+        data[j] = std::move(value);
+    }
+}
+
+// Merges the sorted ranges a[0, na) and b[0, nb) into out; an element of b goes first only if it is less than the
+// element of a.
+template <typename T, typename Compare>
+void merge_range(const T* a, size_t na, const T* b, size_t nb, T* out, Compare& comp) {
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        if (comp(b[j], a[i])) out[k++] = b[j++];
+        else out[k++] = a[i++];
+    }
+    while (i < na) out[k++] = a[i++];
+    while (j < nb) out[k++] = b[j++];
+}
+
+// Same as merge_range(), split into chunks equal parts by co_rank() that are merged as tasks of the pool.
+template <typename T, typename Compare>
+void parallel_merge_range(WorkStealingPool& pool, const T* a, size_t na, const T* b, size_t nb, T* out,
+                          unsigned int first, unsigned int last, unsigned int chunks, Compare& comp) {
+    if (last - first > 1) {
+        unsigned int half = first + (last - first) / 2;
+        pool.fork_join([&] { parallel_merge_range(pool, a, na, b, nb, out, first, half, chunks, comp); },
+                       [&] { parallel_merge_range(pool, a, na, b, nb, out, half, last, chunks, comp); });
+        return;
+    }
+    size_t n = na + nb;
+    size_t begin = n / chunks * first + std::min<size_t>(first, n % chunks);
+    size_t end = n / chunks * last + std::min<size_t>(last, n % chunks);
+    size_t i0 = co_rank(begin, a, na, b, nb, comp), i1 = co_rank(end, a, na, b, nb, comp);
+    merge_range(a + i0, i1 - i0, b + (begin - i0), (end - i1) - (begin - i0), out + begin, comp);
+}
+
+// Ping-pong mergesort of src[left, right) into dst[left, right), both holding the same elements on entry (see
+// pingpong_sort() in PMS.cpp).
+template <typename T, typename Compare>
+void pingpong_sort_range(T* src, T* dst, size_t left, size_t right, Compare& comp) {
+    if (right - left <= sort_leaf_size) {
+        insertion_sort_range(dst + left, right - left, comp);
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+    pingpong_sort_range(dst, src, left, mid, comp);
+    pingpong_sort_range(dst, src, mid, right, comp);
+    merge_range(src + left, mid - left, src + mid, right - mid, dst + left, comp);
+}
+
+// Parallel pingpong_sort_range(): ranges of at least grain elements are split into two tasks of the pool, and their merges are split by
+// merge path.
+template <typename T, typename Compare>
+void task_pingpong_sort_range(WorkStealingPool& pool, T* src, T* dst, size_t left, size_t right, size_t grain,
+                              Compare& comp) {
+    if (right - left < grain) {
+        pingpong_sort_range(src, dst, left, right, comp);
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+    pool.fork_join([&] { task_pingpong_sort_range(pool, dst, src, left, mid, grain, comp); },
+                   [&] { task_pingpong_sort_range(pool, dst, src, mid, right, grain, comp); });
+    // One chunk per thread, each at least grain elements (right - left >= grain, so there is at least one)
+    unsigned int chunks = static_cast<unsigned int>(std::min<size_t>(pool.size(), (right - left) / grain));
+    parallel_merge_range(pool, src + left, mid - left, src + mid, right - mid, dst + left, 0, chunks, chunks, comp);
+}
+
+//------------------------------------------------------------
+// Interface
+
+// Stable sort of [first, last) by comp. The iterators must be contiguous (vector, array, span, pointer) and the
+// elements copyable; one auxiliary buffer of the same size is allocated.
+template <std::contiguous_iterator It, typename Compare = std::less<>>
+void stable_sort_range(It first, It last, Compare comp = {}) {
+    using T = std::iter_value_t<It>;
+    T* data = std::to_address(first);
+    size_t n = static_cast<size_t>(last - first);
+    std::vector<T> buffer(data, data + n);
+    pingpong_sort_range(buffer.data(), data, 0, n, comp);
+}
+
+// Parallel stable_sort_range() on the tasks of pool.
+template <std::contiguous_iterator It, typename Compare = std::less<>>
+void parallel_stable_sort_range(WorkStealingPool& pool, It first, It last, Compare comp = {}) {
+    using T = std::iter_value_t<It>;
+    T* data = std::to_address(first);
+    size_t n = static_cast<size_t>(last - first);
+    std::unique_ptr<T[]> buffer = allocate_untouched<T>(n);
+    parallel_copy(pool, std::span<const T>(data, n), std::span<T>(buffer.get(), n));
+    // At least 4 tasks per thread, so that stealing can even out the work
+    size_t grain = std::max(parallel_sort_grain, n / (4 * static_cast<size_t>(pool.size())));
+    task_pingpong_sort_range(pool, buffer.get(), data, 0, n, grain, comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void stable_sort_span(std::span<T> data, Compare comp = {}) {
+    stable_sort_range(data.begin(), data.end(), comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void parallel_stable_sort_span(WorkStealingPool& pool, std::span<T> data, Compare comp = {}) {
+    parallel_stable_sort_range(pool, data.begin(), data.end(), comp);
+}
+
+// Sorts the parallel arrays keys and values (same length) by key, stably: values[i] stays with keys[i], and values
+// with equal keys keep their order. The pairs are sorted together as records, then written back.
+template <typename Key, typename Value, typename Compare = std::less<>>
+void sort_by_key(std::span<Key> keys, std::span<Value> values, Compare comp = {}) {
+    std::vector<std::pair<Key, Value>> records(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) records[i] = {keys[i], values[i]};
+    auto by_key = [&](const std::pair<Key, Value>& x, const std::pair<Key, Value>& y) { return comp(x.first, y.first); };
+    stable_sort_range(records.begin(), records.end(), by_key);
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i] = records[i].first;
+        values[i] = records[i].second;
+    }
+}
+
+// A key and its value, sorted together by parallel_sort_by_key(). Unlike std::pair it has no constructor, so an array
+// of them can be allocated untouched for trivial keys and values.
+template <typename Key, typename Value>
+struct KeyValueRecord {
+    Key key;
+    Value value;
+};
+
+// Parallel sort_by_key() on the tasks of pool. The records are packed and written back block by block on the pool, with
+// the one-block-per-thread partition of parallel_copy(), so neither copy runs on one thread.
+template <typename Key, typename Value, typename Compare = std::less<>>
+void parallel_sort_by_key(WorkStealingPool& pool, std::span<Key> keys, std::span<Value> values, Compare comp = {}) {
+    using Record = KeyValueRecord<Key, Value>;
+    size_t n = keys.size(), blocks = pool.size();
+    std::unique_ptr<Record[]> records = allocate_untouched<Record>(n);
+    pool.for_each_block(0, blocks, [&](size_t b) {
+        for (size_t i = block_begin(n, blocks, b); i < block_begin(n, blocks, b + 1); i++) {
+            records[i] = {keys[i], values[i]};
+        }
+    });
+    auto by_key = [&](const Record& x, const Record& y) { return comp(x.key, y.key); };
+    parallel_stable_sort_range(pool, records.get(), records.get() + n, by_key);
+    pool.for_each_block(0, blocks, [&](size_t b) {
+        for (size_t i = block_begin(n, blocks, b); i < block_begin(n, blocks, b + 1); i++) {
+            keys[i] = records[i].key;
+            values[i] = records[i].value;
+        }
+    });
+}
+
+#endif
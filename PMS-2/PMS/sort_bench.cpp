@@ -0,0 +1,389 @@
+//
+// CMP202
+// Benchmark suite for the sort variants: seeded input distributions, thread scaling, repeat statistics, CSV/JSON
+//------------------------------------------------------------
+#if defined(_WIN32)
+    #define NOMINMAX
+    #include <windows.h>
+    #include <psapi.h>
+#elif defined(__APPLE__)
+    #include <sys/resource.h>
+#elif defined(__unix__)
+    #include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "sort_bench.h"
+
+const char* distribution_name(Distribution distribution) {
+    switch (distribution) {
+    case Distribution::Uniform: return "uniform";
+    case Distribution::Sorted: return "sorted";
+    case Distribution::Reverse: return "reverse";
+    case Distribution::FewUnique: return "few-unique";
+    case Distribution::OrganPipe: return "organ-pipe";
+    case Distribution::Zipf: return "zipf";
+    }
+    return "?";
+}
+
+std::vector<Distribution> all_distributions() {
+    return {Distribution::Uniform, Distribution::Sorted, Distribution::Reverse,
+            Distribution::FewUnique, Distribution::OrganPipe, Distribution::Zipf};
+}
+
+bool parse_distribution(const std::string& name, Distribution& distribution) {
+    for (Distribution d : all_distributions()) {
+        if (name == distribution_name(d)) {
+            distribution = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+UntouchedVector<int> generate_input(WorkStealingPool& pool, Distribution distribution, size_t n, uint64_t seed) {
+    uint64_t stream = seed ^ (static_cast<uint64_t>(distribution) << 56) ^ n;
+    UntouchedVector<int> data(n);
+    // Zipf: rank k (1-based) of up to 2^20 values with probability proportional to 1 / k, by inverse CDF.
+    std::vector<double> cdf;
+    if (distribution == Distribution::Zipf) {
+        cdf.resize(std::clamp<size_t>(n, 1, size_t(1) << 20));
+        double sum = 0;
+        for (size_t k = 0; k < cdf.size(); k++) cdf[k] = sum += 1.0 / static_cast<double>(k + 1);
+    }
+    auto value = [&](size_t i) {
+        switch (distribution) {
+        case Distribution::Uniform: return static_cast<int>(counter_random(stream, i));
+        case Distribution::Sorted: return static_cast<int>(i);
+        case Distribution::Reverse: return static_cast<int>(n - i);
+        case Distribution::FewUnique: return static_cast<int>(counter_random(stream, i) % 16);
+        case Distribution::OrganPipe: return static_cast<int>(i < n / 2 ? i : n - i);
+        case Distribution::Zipf: {
+            double u = static_cast<double>(counter_random(stream, i) >> 11) * 0x1.0p-53 * cdf.back(); // [0, sum)
+            return static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()) + 1;
+        }
+        }
+        return 0;
+    };
+    // Filled block by block on the pool, like generate_uniform(), so that the pages are placed near the workers
+    size_t blocks = pool.size();
+    pool.for_each_block(0, blocks, [&](size_t b) {
+        for (size_t i = block_begin(n, blocks, b), end = block_begin(n, blocks, b + 1); i < end; i++) data[i] = value(i);
+    });
+    return data;
+}
+
+//------------------------------------------------------------
+// Peak resident memory
+
+// Starts a new peak where the platform allows it (Linux: writing 5 to clear_refs resets VmHWM).
+static void reset_peak_rss() {
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+static long long peak_rss_kb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+    return static_cast<long long>(pmc.PeakWorkingSetSize / 1024);
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::stoll(line.substr(6));
+    }
+    return 0;
+#elif defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    #if defined(__APPLE__)
+        return usage.ru_maxrss / 1024; // Bytes on macOS
+    #else
+        return usage.ru_maxrss;
+    #endif
+#else
+    return 0;
+#endif
+}
+
+//------------------------------------------------------------
+
+// Value at or above fraction q of the sorted times (nearest rank)
+static double percentile(const std::vector<double>& sorted, double q) {
+    size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+std::vector<BenchRow> run_benchmark(const BenchConfig& config, const std::vector<SortVariant>& variants,
+                                    const TuningParams& tuning, const std::atomic<int>& thread_counter) {
+    std::vector<unsigned int> thread_counts = config.threads;
+    if (thread_counts.empty()) {
+        unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int t = 1; t < cores; t *= 2) thread_counts.push_back(t);
+        thread_counts.push_back(cores);
+    }
+    auto selected = [&](size_t v) {
+        return v == 0 || config.variants.empty() ||
+               std::find(config.variants.begin(), config.variants.end(), variants[v].name) != config.variants.end();
+    };
+
+    bool profiling = !config.profile.empty();
+    if (profiling) std::cout << "Phase profile counters: " << phase_counter_status() << std::endl;
+
+    std::vector<BenchRow> rows;
+    for (size_t n : config.sizes) {
+        for (Distribution distribution : config.distributions) {
+            const UntouchedVector<int> input = [&] {
+                WorkStealingPool generator;
+                return generate_input(generator, distribution, n, config.seed);
+            }();
+            // What every variant must produce: std::sort of the same input. Comparing with it (not just is_sorted)
+            // also catches a sort that loses, duplicates or overwrites elements.
+            UntouchedVector<int> expected(input);
+            std::sort(expected.begin(), expected.end());
+            UntouchedVector<int> data(n);
+            double baseline_ms = 0;
+
+            for (unsigned int threads : thread_counts) {
+                WorkStealingPool pool(threads);
+                TuningParams scaled = tuning;
+                scaled.threads = threads;
+                SortContext context{pool, threads, scaled.depth_for(n, 1, tuning.thread_cutoff),
+                                      scaled.depth_for(n, 4, tuning.sequential_cutoff)};
+
+                for (size_t v = 0; v < variants.size(); v++) {
+                    if (!selected(v) || (!variants[v].parallel && threads != thread_counts.front())) continue;
+                    BenchRow row;
+                    row.variant = variants[v].name;
+                    row.distribution = distribution_name(distribution);
+                    row.size = n;
+                    row.threads = variants[v].parallel ? threads : 1;
+                    row.repeats = config.repeats;
+                    row.pool_threads = pool.threads_created();
+
+                    std::vector<double> times;
+                    int counted = thread_counter.load();
+                    reset_peak_rss();
+                    for (int r = 0; r < config.repeats; r++) {
+                        std::copy(input.begin(), input.end(), data.begin());
+                        auto start = std::chrono::steady_clock::now();
+                        variants[v].sort(data, context);
+                        auto end = std::chrono::steady_clock::now();
+                        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                        row.sorted = row.sorted && data == expected;
+                    }
+                    row.peak_rss_kb = peak_rss_kb();
+                    row.threads_per_run = static_cast<double>(thread_counter.load() - counted) / config.repeats;
+
+                    // Profiled apart from the timed repeats, so that reading the counters does not slow them down
+                    if (profiling) {
+                        begin_phase_profile();
+                        {
+                            PhaseScope generation(Phase::DataGeneration);
+                            data = generate_input(pool, distribution, n, config.seed); // On the pool that sorts it
+                        }
+                        {
+                            PhaseScope sort(Phase::Sort);
+                            variants[v].sort(data, context);
+                        }
+                        row.profile = end_phase_profile();
+                        row.sorted = row.sorted && data == expected;
+                    }
+
+                    std::sort(times.begin(), times.end());
+                    row.median_ms = percentile(times, 0.5);
+                    row.p10_ms = percentile(times, 0.1);
+                    row.p90_ms = percentile(times, 0.9);
+                    row.min_ms = times.front();
+                    row.max_ms = times.back();
+                    row.throughput = row.median_ms > 0 ? n / (row.median_ms * 1000.0) : 0;
+                    if (v == 0 && threads == thread_counts.front()) baseline_ms = row.median_ms;
+                    row.speedup = row.median_ms > 0 ? baseline_ms / row.median_ms : 0;
+                    row.efficiency = row.speedup / row.threads;
+                    if (!row.sorted) std::cerr << "Benchmark: " << row.variant << " did not sort " << row.distribution << " input correctly" << std::endl;
+
+                    std::cout << std::left << std::setw(22) << row.variant << std::setw(11) << row.distribution << std::right
+                              << std::setw(11) << n << std::setw(4) << row.threads << " threads  median "
+                              << std::setw(10) << std::fixed << std::setprecision(3) << row.median_ms << " ms  p90 "
+                              << std::setw(10) << row.p90_ms << " ms  speedup " << std::setprecision(2) << row.speedup
+                              << std::defaultfloat << std::setprecision(6) << std::endl;
+                    if (profiling) print_phase_profile(std::cout, row.profile);
+                    rows.push_back(row);
+                }
+            }
+        }
+    }
+    return rows;
+}
+
+bool write_benchmark(const std::string& path, const std::vector<BenchRow>& rows) {
+    std::ofstream out(path);
+    if (!out) return false;
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+
+    if (json) out << "[";
+    else out << "variant,distribution,size,threads,repeats,median_ms,p10_ms,p90_ms,min_ms,max_ms,throughput_meps,"
+                "speedup,efficiency,peak_rss_kb,threads_per_run,pool_threads,sorted,"
+                "cycles,instructions,llc_misses,branch_misses,context_switches\n";
+    for (size_t i = 0; i < rows.size(); i++) {
+        const BenchRow& r = rows[i];
+        PhaseCounters c = r.profile.total();
+        if (r.profile.samples.empty()) {
+            c.cycles = c.instructions = c.llc_misses = c.branch_misses = c.context_switches = -1;
+        }
+        if (json) {
+            out << (i == 0 ? "\n" : ",\n") << "  {\"variant\": \"" << r.variant << "\", \"distribution\": \"" << r.distribution
+                << "\", \"size\": " << r.size << ", \"threads\": " << r.threads << ", \"repeats\": " << r.repeats
+                << ", \"median_ms\": " << r.median_ms << ", \"p10_ms\": " << r.p10_ms << ", \"p90_ms\": " << r.p90_ms
+                << ", \"min_ms\": " << r.min_ms << ", \"max_ms\": " << r.max_ms << ", \"throughput_meps\": " << r.throughput
+                << ", \"speedup\": " << r.speedup << ", \"efficiency\": " << r.efficiency << ", \"peak_rss_kb\": " << r.peak_rss_kb
+                << ", \"threads_per_run\": " << r.threads_per_run << ", \"pool_threads\": " << r.pool_threads
+                << ", \"sorted\": " << (r.sorted ? "true" : "false") << ", \"cycles\": " << c.cycles
+                << ", \"instructions\": " << c.instructions << ", \"llc_misses\": " << c.llc_misses
+                << ", \"branch_misses\": " << c.branch_misses << ", \"context_switches\": " << c.context_switches
+                << "}";
+        }
+        else {
+            out << r.variant << "," << r.distribution << "," << r.size << "," << r.threads << "," << r.repeats << ","
+                << r.median_ms << "," << r.p10_ms << "," << r.p90_ms << "," << r.min_ms << "," << r.max_ms << ","
+                << r.throughput << "," << r.speedup << "," << r.efficiency << "," << r.peak_rss_kb << ","
+                << r.threads_per_run << "," << r.pool_threads << "," << (r.sorted ? 1 : 0) << "," << c.cycles << ","
+                << c.instructions << "," << c.llc_misses << "," << c.branch_misses << "," << c.context_switches << "\n";
+        }
+    }
+    if (json) out << "\n]\n";
+    return static_cast<bool>(out);
+}
+
+bool write_phase_profiles(const std::string& path, const std::vector<BenchRow>& rows) {
+    std::ofstream out(path);
+    if (!out) return false;
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+
+    if (json) out << "[";
+    else out << "variant,distribution,size,threads,phase,thread,ms,cycles,instructions,ipc,llc_misses,branch_misses,"
+                "context_switches\n";
+    bool first = true;
+    for (const BenchRow& r : rows) {
+        for (const PhaseSample& sample : r.profile.samples) {
+            const PhaseCounters& c = sample.counters;
+            if (json) {
+                out << (first ? "\n" : ",\n") << "  {\"variant\": \"" << r.variant << "\", \"distribution\": \""
+                    << r.distribution << "\", \"size\": " << r.size << ", \"threads\": " << r.threads
+                    << ", \"phase\": \"" << sample.phase << "\", \"thread\": " << sample.thread << ", \"ms\": " << c.ms
+                    << ", \"cycles\": " << c.cycles << ", \"instructions\": " << c.instructions
+                    << ", \"ipc\": " << c.ipc()
+                    << ", \"llc_misses\": " << c.llc_misses << ", \"branch_misses\": " << c.branch_misses
+                    << ", \"context_switches\": " << c.context_switches << "}";
+            }
+            else {
+                out << r.variant << "," << r.distribution << "," << r.size << "," << r.threads << "," << sample.phase
+                    << "," << sample.thread << "," << c.ms << "," << c.cycles << "," << c.instructions << "," << c.ipc()
+                    << "," << c.llc_misses << "," << c.branch_misses << "," << c.context_switches << "\n";
+            }
+            first = false;
+        }
+    }
+    if (json) out << "\n]\n";
+    return static_cast<bool>(out);
+}
+
+// Splits "a,b,c" into its parts
+static std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> parts;
+    std::stringstream stream(list);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+static void print_bench_usage() {
+    std::cerr << "Usage: PMS --bench [--sizes N,N] [--distributions a,b] [--threads N,N] [--variants \"a,b\"] [--repeats N]"
+                 " [--seed N] [--out FILE] [--profile FILE]" << std::endl;
+}
+
+int bench_main(int argc, char* argv[], const std::vector<SortVariant>& variants, const TuningParams& tuning,
+               const std::atomic<int>& thread_counter) {
+    BenchConfig config;
+    for (int i = 2; i < argc; i += 2) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            print_bench_usage();
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        try {
+            if (option == "--sizes") {
+                config.sizes.clear();
+                for (const std::string& size : split_list(value)) {
+                    double n = std::stod(size); // Accepts "1e6"
+                    if (!(n >= 1 && n <= static_cast<double>(SIZE_MAX / sizeof(int)))) throw std::out_of_range(size);
+                    config.sizes.push_back(static_cast<size_t>(n));
+                }
+            }
+            else if (option == "--distributions") {
+                config.distributions.clear();
+                for (const std::string& name : split_list(value)) {
+                    Distribution distribution;
+                    if (!parse_distribution(name, distribution)) {
+                        std::cerr << "Unknown distribution " << name << std::endl;
+                        return 1;
+                    }
+                    config.distributions.push_back(distribution);
+                }
+            }
+            else if (option == "--threads") {
+                config.threads.clear();
+                for (const std::string& count : split_list(value)) config.threads.push_back(std::max(1, std::stoi(count)));
+            }
+            else if (option == "--variants") config.variants = split_list(value);
+            else if (option == "--repeats") config.repeats = std::max(1, std::stoi(value));
+            else if (option == "--seed") config.seed = std::stoull(value);
+            else if (option == "--out") config.out = value;
+            else if (option == "--profile") config.profile = value;
+            else {
+                std::cerr << "Unknown option " << option << std::endl;
+                print_bench_usage();
+                return 1;
+            }
+        }
+        catch (const std::logic_error&) { // std::stoi, std::stod, std::stoull: not a number, or out of range
+            std::cerr << "Bad value for " << option << ": " << value << std::endl;
+            print_bench_usage();
+            return 1;
+        }
+    }
+
+    std::vector<BenchRow> rows = run_benchmark(config, variants, tuning, thread_counter);
+    if (!config.out.empty()) {
+        if (!write_benchmark(config.out, rows)) {
+            std::cerr << "Cannot write " << config.out << std::endl;
+            return 1;
+        }
+        std::cout << "Results written to " << config.out << std::endl;
+    }
+    if (!config.profile.empty()) {
+        if (!write_phase_profiles(config.profile, rows)) {
+            std::cerr << "Cannot write " << config.profile << std::endl;
+            return 1;
+        }
+        std::cout << "Phase profiles written to " << config.profile << std::endl;
+    }
+    bool all_sorted = std::all_of(rows.begin(), rows.end(), [](const BenchRow& row) { return row.sorted; });
+    return all_sorted ? 0 : 1;
+}
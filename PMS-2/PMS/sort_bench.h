@@ -0,0 +1,90 @@
+//
+// CMP202
+// Benchmark suite for the sort variants: seeded input distributions, thread scaling, repeat statistics, CSV/JSON
+//------------------------------------------------------------
+#ifndef SORT_BENCH_H
+#define SORT_BENCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "data_gen.h"
+#include "phase_profiler.h"
+#include "tuning.h"
+#include "work_stealing_pool.h"
+
+// What a sort variant may use: a pool with the number of threads being measured, and split depths for that number
+struct SortContext {
+    WorkStealingPool& pool;
+    unsigned int threads;
+    int thread_depth;   // For thread-per-split sorts: about one leaf per thread
+    int task_depth;     // For pool sorts: several tasks per thread
+};
+
+struct SortVariant {
+    std::string name;
+    bool parallel;      // Sequential variants are only measured with one thread
+    std::function<void(UntouchedVector<int>&, const SortContext&)> sort;
+};
+
+enum class Distribution { Uniform, Sorted, Reverse, FewUnique, OrganPipe, Zipf };
+
+const char* distribution_name(Distribution distribution);
+bool parse_distribution(const std::string& name, Distribution& distribution);
+std::vector<Distribution> all_distributions();
+
+// The same seed, distribution and size always give the same input, whatever the number of threads of the pool that
+// generates it (block by block, so that the workers first touch the pages; data_gen.h)
+UntouchedVector<int> generate_input(WorkStealingPool& pool, Distribution distribution, size_t n, uint64_t seed);
+
+struct BenchConfig {
+    std::vector<size_t> sizes{100000, 1000000};
+    std::vector<Distribution> distributions = all_distributions();
+    std::vector<unsigned int> threads;      // Empty: 1, 2, 4, ... up to and including every core
+    std::vector<std::string> variants;      // Empty: all; the first variant always runs, as the speedup baseline
+    int repeats = 5;
+    uint64_t seed = 202;
+    std::string out;                        // CSV, or JSON if the name ends in .json; nothing if empty
+    std::string profile;                    // If set, one more run of each row is profiled by phase and thread
+                                            // (phase_profiler.h) and the samples are written here, CSV or JSON
+};
+
+// Statistics of the repeats of one variant on one input with one thread count
+struct BenchRow {
+    std::string variant;
+    std::string distribution;
+    size_t size = 0;
+    unsigned int threads = 1;
+    int repeats = 0;
+    double median_ms = 0, p10_ms = 0, p90_ms = 0, min_ms = 0, max_ms = 0;
+    double throughput = 0;                  // Million elements per second, at the median time
+    double speedup = 0;                     // Against the first variant with one thread on the same input
+    double efficiency = 0;                  // speedup / threads
+    long long peak_rss_kb = 0;              // Peak resident memory during these repeats (since start where it cannot be reset)
+    double threads_per_run = 0;             // Threads created by each sort (pool workers are created once, not per sort)
+    unsigned int pool_threads = 0;          // Workers of the pool the variant ran on
+    bool sorted = true;                     // Every repeat produced the same output as std::sort of the input
+    PhaseProfile profile;                   // The profiled run, with the generation of its input; empty if not profiled
+};
+
+// Runs every selected variant on every input for every thread count, each on a fresh copy of the same input.
+// thread_counter is the counter the thread-per-split sorts add their threads to.
+std::vector<BenchRow> run_benchmark(const BenchConfig& config, const std::vector<SortVariant>& variants,
+                                    const TuningParams& tuning, const std::atomic<int>& thread_counter);
+
+// Writes the rows; their phase profiles are summed into counter columns (-1 if not profiled or not available)
+bool write_benchmark(const std::string& path, const std::vector<BenchRow>& rows);
+
+// Writes one line per row, phase and thread of the profiled runs
+bool write_phase_profiles(const std::string& path, const std::vector<BenchRow>& rows);
+
+// PMS --bench [--sizes N,N] [--distributions a,b] [--threads N,N] [--variants "a,b"] [--repeats N] [--seed N] [--out FILE]
+//           [--profile FILE]
+int bench_main(int argc, char* argv[], const std::vector<SortVariant>& variants, const TuningParams& tuning,
+               const std::atomic<int>& thread_counter);
+
+#endif
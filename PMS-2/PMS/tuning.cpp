@@ -0,0 +1,177 @@
+//
+// CMP202
+// Auto-tuning of the parallel sort parameters: cache sizes, micro-benchmarks, and a cache file for the results
+//------------------------------------------------------------
+#if defined(_WIN32)
+    #define NOMINMAX       // Keeps windows.h from defining min and max macros, which break std::min and std::max
+    #include <windows.h>
+#elif defined(__APPLE__)
+    #include <sys/sysctl.h>
+#elif defined(__unix__)
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "sort_api.h"
+#include "tuning.h"
+
+int TuningParams::depth_for(size_t n, unsigned int tasks_per_thread, size_t cutoff) const {
+    int depth = 0;
+    while ((size_t(1) << depth) < static_cast<size_t>(threads) * tasks_per_thread && (n >> depth) >= cutoff) {
+        depth++;
+    }
+    return depth;
+}
+
+void detect_caches(TuningParams& params) {
+#if defined(_WIN32)
+    DWORD bytes = 0;
+    GetLogicalProcessorInformation(nullptr, &bytes);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &bytes)) {
+        for (const auto& entry : info) {
+            if (entry.Relationship != RelationCache) continue;
+            if (entry.Cache.Level == 1 && entry.Cache.Type != CacheInstruction) params.l1_cache = entry.Cache.Size;
+            if (entry.Cache.Level == 2) params.l2_cache = entry.Cache.Size;
+        }
+    }
+#elif defined(__APPLE__)
+    size_t value = 0, size = sizeof(value);
+    if (sysctlbyname("hw.l1dcachesize", &value, &size, nullptr, 0) == 0 && value > 0) params.l1_cache = value;
+    size = sizeof(value);
+    if (sysctlbyname("hw.l2cachesize", &value, &size, nullptr, 0) == 0 && value > 0) params.l2_cache = value;
+#elif defined(__unix__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE), l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l1 > 0) params.l1_cache = static_cast<size_t>(l1);
+    if (l2 > 0) params.l2_cache = static_cast<size_t>(l2);
+#endif
+}
+
+// Best of three runs of body, in seconds; every run first refills data from input.
+template <typename Data, typename Body>
+static double best_time(Data& data, const std::vector<int>& input, const Body& body) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 3; run++) {
+        std::copy(input.begin(), input.end(), data.begin());
+        auto start = std::chrono::steady_clock::now();
+        body();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+TuningParams calibrate(WorkStealingPool& pool, const RangeSort& thread_sort) {
+    TuningParams params;
+    params.threads = pool.size();
+    detect_caches(params);
+
+    std::mt19937 gen(202);
+    auto random_input = [&](size_t n) {
+        std::vector<int> input(n);
+        for (int& value : input) value = static_cast<int>(gen());
+        return input;
+    };
+
+    // Leaf size: an array of twice the L2 cache (within 256 KB and 1 MB, to keep the calibration short).
+    {
+        std::vector<int> input = random_input(std::clamp<size_t>(2 * params.l2_cache / sizeof(int), 1 << 16, 1 << 18));
+        std::vector<int> data(input.size());
+        size_t saved = sort_leaf_size;
+        double best = std::numeric_limits<double>::max();
+        for (size_t leaf = 8; leaf <= 128; leaf *= 2) {
+            sort_leaf_size = leaf;
+            double time = best_time(data, input, [&] { stable_sort_range(data.begin(), data.end()); });
+            if (time < best) {
+                best = time;
+                params.leaf_size = leaf;
+            }
+        }
+        sort_leaf_size = saved;
+    }
+
+    // Cutoffs: both halves sorted one after the other by sort, against the same halves sorted at the same time by
+    // split(). The result is the size of the range that is split, which is how the sorts compare it.
+    auto generic_sort = [](UntouchedVector<int>& data, size_t begin, size_t end) {
+        stable_sort_range(data.begin() + begin, data.begin() + end);
+    };
+    auto measure_cutoff = [&](const auto& sort, const auto& split) {
+        if (pool.size() < 2) return std::numeric_limits<size_t>::max();
+        for (size_t n = std::max<size_t>(params.l1_cache / sizeof(int), 1024); n <= (size_t(1) << 20); n *= 2) {
+            std::vector<int> input = random_input(n);
+            UntouchedVector<int> data(n);
+            auto left = [&] { sort(data, 0, n / 2); };
+            auto right = [&] { sort(data, n / 2, n); };
+            double sequential = best_time(data, input, [&] { left(); right(); });
+            double parallel = best_time(data, input, [&] { split(left, right); });
+            if (parallel < 0.9 * sequential) return n;
+        }
+        return std::numeric_limits<size_t>::max();
+    };
+    params.sequential_cutoff = measure_cutoff(generic_sort, [&](const auto& left, const auto& right) {
+        pool.fork_join(left, right);
+    });
+    auto thread_halves = [&](UntouchedVector<int>& data, size_t begin, size_t end) {
+        if (thread_sort) thread_sort(data, begin, end);
+        else generic_sort(data, begin, end);
+    };
+    params.thread_cutoff = measure_cutoff(thread_halves, [](const auto& left, const auto& right) {
+        std::thread left_thread(left), right_thread(right); // As partial_parallel_mergesort splits
+        left_thread.join();
+        right_thread.join();
+    });
+    return params;
+}
+
+bool load_tuning(const std::string& path, TuningParams& params) {
+    std::ifstream file(path);
+    if (!file) return false;
+    TuningParams loaded;
+    std::string key;
+    for (const char* expected : {"threads", "l1_cache", "l2_cache", "sequential_cutoff", "thread_cutoff", "leaf_size"}) {
+        if (!(file >> key) || key != expected) return false;
+        if (key == "threads") file >> loaded.threads;
+        else if (key == "l1_cache") file >> loaded.l1_cache;
+        else if (key == "l2_cache") file >> loaded.l2_cache;
+        else if (key == "sequential_cutoff") file >> loaded.sequential_cutoff;
+        else if (key == "thread_cutoff") file >> loaded.thread_cutoff;
+        else file >> loaded.leaf_size;
+    }
+    if (!file) return false;
+    // A leaf or cutoff of 0 or 1 would split ranges of one element forever.
+    if (loaded.threads < 1 || loaded.leaf_size < 2 || loaded.sequential_cutoff < 2 || loaded.thread_cutoff < 2) {
+        return false;
+    }
+    params = loaded;
+    return true;
+}
+
+void save_tuning(const std::string& path, const TuningParams& params) {
+    std::ofstream file(path);
+    file << "threads " << params.threads << "\n"
+         << "l1_cache " << params.l1_cache << "\n"
+         << "l2_cache " << params.l2_cache << "\n"
+         << "sequential_cutoff " << params.sequential_cutoff << "\n"
+         << "thread_cutoff " << params.thread_cutoff << "\n"
+         << "leaf_size " << params.leaf_size << "\n";
+}
+
+TuningParams load_or_calibrate(WorkStealingPool& pool, const std::string& path, bool force, const RangeSort& thread_sort) {
+    TuningParams current;
+    current.threads = pool.size();
+    detect_caches(current);
+
+    TuningParams params;
+    bool same_hardware = load_tuning(path, params) && params.threads == current.threads &&
+                         params.l1_cache == current.l1_cache && params.l2_cache == current.l2_cache;
+    if (!force && same_hardware) return params;
+    params = calibrate(pool, thread_sort);
+    save_tuning(path, params);
+    return params;
+}
@@ -0,0 +1,59 @@
+//
+// CMP202
+// Auto-tuning of the parallel sort parameters: cache sizes, micro-benchmarks, and a cache file for the results
+//------------------------------------------------------------
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "data_gen.h"
+#include "work_stealing_pool.h"
+
+// Default cache file, in the working directory
+const char* const TUNING_FILE = "pms_tuning.txt";
+
+struct TuningParams {
+    // Hardware the parameters were measured on; a cache file from other hardware is measured again
+    unsigned int threads = 1;
+    size_t l1_cache = 32 * 1024;        // Bytes of L1 data cache per core
+    size_t l2_cache = 256 * 1024;       // Bytes of L2 cache per core
+
+    // Measured. A cutoff is the smallest range that is split in two (as tasks of the pool, or as two new threads);
+    // smaller ranges are sorted sequentially.
+    size_t sequential_cutoff = 10000000; // For the sorts on the work-stealing pool
+    size_t thread_cutoff = 10000000;     // For the thread-per-split sort (partial_parallel_mergesort)
+    size_t leaf_size = 32;               // Insertion-sort leaves of the generic sort
+
+    // Split depth for sorting n elements with about tasks_per_thread leaves per thread: deep enough for every thread,
+    // but no deeper than the given cutoff allows (a split depth of d gives 2^d leaves).
+    int depth_for(size_t n, unsigned int tasks_per_thread, size_t cutoff) const;
+};
+
+// Sorts data[begin, end): the sequential sort a parallel sort runs on each half once it stops splitting
+using RangeSort = std::function<void(UntouchedVector<int>& data, size_t begin, size_t end)>;
+
+// Cache sizes of this machine, or the defaults above where the platform does not say
+void detect_caches(TuningParams& params);
+
+// Measures the leaf size and the sequential cutoff on this machine (well under a second):
+//  - leaf size: the fastest generic sort of an array about twice the size of L2, over leaf sizes from 8 to 128;
+//  - cutoffs: the smallest size, from L1-sized up, at which sorting the halves at the same time beats sorting them one
+//    after the other, once with two tasks of the pool and once with two new threads, the way each kind of sort splits.
+//    The halves are sorted by the generic stable sort, and by thread_sort for the thread cutoff if one is given (the
+//    sort partial_parallel_mergesort runs on its halves). With one thread, or if splitting never pays, nothing is split.
+TuningParams calibrate(WorkStealingPool& pool, const RangeSort& thread_sort = {});
+
+// Reads the parameters from path. False if the file is missing, not in the format save_tuning() writes, or holds values
+// the sorts cannot use (fewer than 1 thread, a leaf size or cutoff below 2), so that they are measured again.
+bool load_tuning(const std::string& path, TuningParams& params);
+void save_tuning(const std::string& path, const TuningParams& params);
+
+// The cached parameters if they were measured with the same threads and caches, else calibrate() and save them;
+// force always measures again.
+TuningParams load_or_calibrate(WorkStealingPool& pool, const std::string& path, bool force,
+                               const RangeSort& thread_sort = {});
+
+#endif
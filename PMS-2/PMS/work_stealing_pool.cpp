@@ -0,0 +1,98 @@
+//
+// CMP202
+// Work-stealing task pool with fork/join, for the recursive splits of the parallel mergesort
+//------------------------------------------------------------
+#include "work_stealing_pool.h"
+
+// Index of the pool worker running on this thread, or -1 on any other thread
+static thread_local int worker_index = -1;
+static thread_local const WorkStealingPool* worker_pool = nullptr;
+
+WorkStealingPool::WorkStealingPool(unsigned int threads) {
+    if (threads == 0) threads = 1;
+    for (unsigned int i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<JobQueue>());
+    }
+    for (unsigned int i = 0; i + 1 < threads; i++) {
+        workers.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stopping = true;
+    queued.fetch_add(1);        // Wakes the sleeping workers so that they see stopping
+    queued.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+unsigned int WorkStealingPool::my_queue() const {
+    // Threads that are not workers of this pool (such as main) share the last queue.
+    if (worker_pool == this && worker_index >= 0) return static_cast<unsigned int>(worker_index);
+    return static_cast<unsigned int>(queues.size() - 1);
+}
+
+void WorkStealingPool::push(PoolJob* job) {
+    JobQueue& q = *queues[my_queue()];
+    {
+        std::lock_guard<ProfiledMutex> lock(q.mutex);
+        q.jobs.push_back(job);
+    }
+    queued.fetch_add(1);
+    queued.notify_one();
+}
+
+bool WorkStealingPool::pop_if_back(PoolJob* job) {
+    JobQueue& q = *queues[my_queue()];
+    std::lock_guard<ProfiledMutex> lock(q.mutex);
+    if (q.jobs.empty() || q.jobs.back() != job) return false;
+    q.jobs.pop_back();
+    queued.fetch_sub(1);
+    return true;
+}
+
+PoolJob* WorkStealingPool::steal(unsigned int thief) {
+    unsigned int n = static_cast<unsigned int>(queues.size());
+    for (unsigned int k = 1; k <= n; k++) {
+        JobQueue& q = *queues[(thief + k) % n];
+        std::lock_guard<ProfiledMutex> lock(q.mutex);
+        if (!q.jobs.empty()) {
+            PoolJob* job = q.jobs.front();
+            q.jobs.pop_front();
+            queued.fetch_sub(1);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void WorkStealingPool::execute(PoolJob* job) {
+    job->run(job);
+    job->done.store(true, std::memory_order_release);
+}
+
+void WorkStealingPool::help_until(const std::atomic<bool>& done) {
+    unsigned int me = my_queue();
+    while (!done.load(std::memory_order_acquire)) {
+        if (PoolJob* job = steal(me)) {
+            execute(job);
+        }
+        else {
+            std::this_thread::yield();      // The stolen job is still running; nothing else to do yet
+        }
+    }
+}
+
+void WorkStealingPool::worker_loop(unsigned int index) {
+    worker_index = static_cast<int>(index);
+    worker_pool = this;
+    while (!stopping) {
+        if (PoolJob* job = steal(index)) {
+            execute(job);
+        }
+        else {
+            queued.wait(0);                 // Sleeps until a job is pushed (or the pool is stopping)
+        }
+    }
+}
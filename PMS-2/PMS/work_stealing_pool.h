@@ -0,0 +1,95 @@
+//
+// CMP202
+// Work-stealing task pool with fork/join, for the recursive splits of the parallel mergesort
+//------------------------------------------------------------
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../../common/lock_profiler.h"
+
+// A unit of work. Jobs live on the stack of the fork_join() call that created them, which does not return until the
+// job has run, so the pool never allocates or frees them.
+struct PoolJob {
+    void (*run)(PoolJob*);       // Runs the job
+    std::atomic<bool> done{false};
+};
+
+// A fixed set of worker threads, created once. Every worker has its own deque of jobs: it pushes and pops at the back
+// (newest first, which keeps its data in cache), and idle workers steal from the front of other deques (the oldest,
+// biggest pieces of work).
+class WorkStealingPool {
+public:
+    // Creates threads - 1 workers; the thread that calls fork_join() is the last participant.
+    explicit WorkStealingPool(unsigned int threads = std::thread::hardware_concurrency());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Runs a and b, possibly in parallel, and returns when both have finished. b is offered to the other workers and a
+    // runs on the calling thread; if nobody has taken b by then, the caller runs it too. While waiting for a stolen b
+    // the caller runs other jobs instead of blocking.
+    template <typename A, typename B>
+    void fork_join(A&& a, B&& b) {
+        struct Job : PoolJob {
+            std::remove_reference_t<B>* body;
+        } job;
+        job.body = &b;
+        job.run = [](PoolJob* j) { (*static_cast<Job*>(j)->body)(); };
+
+        push(&job);
+        a();
+        if (pop_if_back(&job)) {
+            job.run(&job);                 // Nobody stole it: run it here, like a plain recursive call.
+        }
+        else {
+            help_until(job.done);           // Stolen: work on something else until the thief has finished it.
+        }
+    }
+
+    // Runs body(i) for every i in [first, last), halving the range with fork_join() down to one index per task.
+    template <typename Body>
+    void for_each_block(size_t first, size_t last, const Body& body) {
+        if (last - first > 1) {
+            size_t half = first + (last - first) / 2;
+            fork_join([&] { for_each_block(first, half, body); },
+                      [&] { for_each_block(half, last, body); });
+        }
+        else if (last > first) {
+            body(first);
+        }
+    }
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()) + 1; } // Participating threads
+    unsigned int threads_created() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+    struct alignas(64) JobQueue {
+        ProfiledMutex mutex{"pool queue"};
+        std::deque<PoolJob*> jobs;
+    };
+
+    void push(PoolJob* job);
+    bool pop_if_back(PoolJob* job);        // Removes job if it is still the newest job of this thread's queue
+    PoolJob* steal(unsigned int thief);     // Takes the oldest job of another queue, or nullptr if there is none
+    void execute(PoolJob* job);
+    void help_until(const std::atomic<bool>& done);
+    void worker_loop(unsigned int index);
+    unsigned int my_queue() const;
+
+    std::vector<std::unique_ptr<JobQueue>> queues;   // One per worker, plus the last one shared by outside threads
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{0};                      // Jobs waiting in any queue; idle workers sleep while it is 0
+    std::atomic<bool> stopping{false};
+};
+
+#endif
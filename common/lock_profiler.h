@@ -0,0 +1,289 @@
+// Contention profiling for the locks of the Elevator, PMS and locking programs.
+//
+// ProfiledMutex and ProfiledSemaphore are drop-in replacements for std::mutex and std::counting_semaphore that take a
+// name. Built with LOCK_PROFILING defined to 1, every named lock counts its acquisitions and contended acquisitions and
+// records how long threads waited for it and (mutexes) how long they held it, in log2 histograms. The counts go to
+// thread-local tables, so recording never touches shared memory; a thread's table is merged into the global report
+// when the thread exits, and printLockReport() merges the calling thread's own table before printing. Locks with the
+// same name share one entry (e.g. all the stripes of a striped lock).
+//
+// Without LOCK_PROFILING (the default) the wrappers are the standard types with a constructor that ignores the name,
+// and printLockReport() does nothing, so the instrumentation costs nothing.
+#ifndef LOCK_PROFILER_H
+#define LOCK_PROFILER_H
+
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+    #include <semaphore>
+    #define LOCK_PROFILER_HAS_SEMAPHORE 1
+#endif
+
+#ifndef LOCK_PROFILING
+    #define LOCK_PROFILING 0
+#endif
+
+#if LOCK_PROFILING
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace lock_profiler {
+
+const int BUCKETS = 40; // Bucket b holds durations in [2^(b-1), 2^b) nanoseconds; bucket 0 holds 0
+
+struct LockCounters {
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0; // Acquisitions that had to wait
+    uint64_t waitNs = 0;
+    uint64_t holdNs = 0;
+    uint64_t wait[BUCKETS] = {};
+    uint64_t hold[BUCKETS] = {};
+
+    void add(const LockCounters& other) {
+        acquisitions += other.acquisitions;
+        contended += other.contended;
+        waitNs += other.waitNs;
+        holdNs += other.holdNs;
+        for (int b = 0; b < BUCKETS; b++) {
+            wait[b] += other.wait[b];
+            hold[b] += other.hold[b];
+        }
+    }
+};
+
+inline int bucketOf(uint64_t ns) {
+    int b = 0;
+    while (ns > 0 && b < BUCKETS - 1) {
+        ns >>= 1;
+        b++;
+    }
+    return b;
+}
+
+// Upper bound of the bucket holding the given percentile of a histogram
+inline uint64_t percentileNs(const uint64_t (&histogram)[BUCKETS], uint64_t total, double percentile) {
+    uint64_t target = static_cast<uint64_t>(total * percentile / 100.0), seen = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += histogram[b];
+        if (seen > target) return b == 0 ? 0 : (uint64_t(1) << b) - 1;
+    }
+    return (uint64_t(1) << (BUCKETS - 1)) - 1;
+}
+
+inline uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Names of the locks and the counters merged from threads that have finished
+struct Registry {
+    std::mutex mutex; // A plain mutex: the profiler does not profile itself
+    std::vector<std::string> names;
+    std::vector<LockCounters> merged;
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Id of the lock called name, registering it the first time
+inline size_t lockId(const char* name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t id = 0; id < r.names.size(); id++) {
+        if (r.names[id] == name) return id;
+    }
+    r.names.push_back(name);
+    r.merged.emplace_back();
+    return r.names.size() - 1;
+}
+
+// The counters of one thread, merged into the registry when the thread exits
+struct ThreadCounters {
+    std::vector<LockCounters> locks;
+
+    LockCounters& of(size_t id) {
+        if (id >= locks.size()) locks.resize(id + 1);
+        return locks[id];
+    }
+
+    void mergeInto(Registry& r) {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t id = 0; id < locks.size() && id < r.merged.size(); id++) r.merged[id].add(locks[id]);
+        locks.clear();
+    }
+
+    ~ThreadCounters() { mergeInto(registry()); }
+};
+
+inline ThreadCounters& threadCounters() {
+    registry(); // Constructed first, so that it outlives every thread's counters
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+inline void recordAcquire(size_t id, uint64_t waitNs, bool contended) {
+    LockCounters& c = threadCounters().of(id);
+    c.acquisitions++;
+    c.contended += contended ? 1 : 0;
+    c.waitNs += waitNs;
+    c.wait[bucketOf(waitNs)]++;
+}
+
+inline void recordHold(size_t id, uint64_t holdNs) {
+    LockCounters& c = threadCounters().of(id);
+    c.holdNs += holdNs;
+    c.hold[bucketOf(holdNs)]++;
+}
+
+} // namespace lock_profiler
+
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char* name = "unnamed mutex") : id_(lock_profiler::lockId(name)) {}
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock() {
+        if (mutex_.try_lock()) {
+            lock_profiler::recordAcquire(id_, 0, false);
+        }
+        else {
+            uint64_t start = lock_profiler::nowNs();
+            mutex_.lock();
+            lock_profiler::recordAcquire(id_, lock_profiler::nowNs() - start, true);
+        }
+        acquired_ = lock_profiler::nowNs(); // Only the owner writes or reads this, under the lock
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) return false;
+        lock_profiler::recordAcquire(id_, 0, false);
+        acquired_ = lock_profiler::nowNs();
+        return true;
+    }
+
+    void unlock() {
+        lock_profiler::recordHold(id_, lock_profiler::nowNs() - acquired_);
+        mutex_.unlock();
+    }
+
+private:
+    std::mutex mutex_;
+    size_t id_;
+    uint64_t acquired_ = 0;
+};
+
+#ifdef LOCK_PROFILER_HAS_SEMAPHORE
+// Records waits only: a permit may be released by another thread than the one that took it, so there is no hold time.
+template <std::ptrdiff_t LeastMaxValue = 1024>
+class ProfiledSemaphore {
+public:
+    ProfiledSemaphore(const char* name, std::ptrdiff_t desired) : semaphore_(desired), id_(lock_profiler::lockId(name)) {}
+    ProfiledSemaphore(const ProfiledSemaphore&) = delete;
+    ProfiledSemaphore& operator=(const ProfiledSemaphore&) = delete;
+
+    void acquire() {
+        if (semaphore_.try_acquire()) {
+            lock_profiler::recordAcquire(id_, 0, false);
+            return;
+        }
+        uint64_t start = lock_profiler::nowNs();
+        semaphore_.acquire();
+        lock_profiler::recordAcquire(id_, lock_profiler::nowNs() - start, true);
+    }
+
+    bool try_acquire() {
+        if (!semaphore_.try_acquire()) return false;
+        lock_profiler::recordAcquire(id_, 0, false);
+        return true;
+    }
+
+    void release(std::ptrdiff_t update = 1) { semaphore_.release(update); }
+
+    static constexpr std::ptrdiff_t max() noexcept { return std::counting_semaphore<LeastMaxValue>::max(); }
+
+private:
+    std::counting_semaphore<LeastMaxValue> semaphore_;
+    size_t id_;
+};
+#endif
+
+// Prints one line per named lock: acquisitions, share contended, and wait and hold time in microseconds (mean, and p50
+// and p99 as bucket upper bounds). Threads that are still running have not been merged yet, except the calling thread.
+inline void printLockReport(std::ostream& out) {
+    using namespace lock_profiler;
+    Registry& r = registry();
+    threadCounters().mergeInto(r);
+
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    std::lock_guard<std::mutex> lock(r.mutex);
+    out << "Lock report (times in microseconds)\n" << std::left << std::setw(20) << "lock" << std::right
+        << std::setw(12) << "acquired" << std::setw(11) << "contended" << std::setw(12) << "wait mean" << std::setw(12)
+        << "wait p50" << std::setw(12) << "wait p99" << std::setw(12) << "hold mean" << std::setw(12) << "hold p50"
+        << std::setw(12) << "hold p99" << "\n" << std::fixed << std::setprecision(1);
+    bool any = false;
+    for (size_t id = 0; id < r.names.size(); id++) {
+        const LockCounters& c = r.merged[id];
+        if (c.acquisitions == 0) continue;
+        any = true;
+        uint64_t holds = 0;
+        for (int b = 0; b < BUCKETS; b++) holds += c.hold[b];
+        out << std::left << std::setw(20) << r.names[id] << std::right << std::setw(12) << c.acquisitions
+            << std::setw(10) << 100.0 * c.contended / c.acquisitions << "%"
+            << std::setw(12) << us(c.waitNs / c.acquisitions) << std::setw(12) << us(percentileNs(c.wait, c.acquisitions, 50))
+            << std::setw(12) << us(percentileNs(c.wait, c.acquisitions, 99));
+        if (holds > 0) {
+            out << std::setw(12) << us(c.holdNs / holds) << std::setw(12) << us(percentileNs(c.hold, holds, 50))
+                << std::setw(12) << us(percentileNs(c.hold, holds, 99));
+        }
+        else {
+            out << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << "-";
+        }
+        out << "\n";
+    }
+    if (!any) out << "(no lock was taken)\n";
+    out << std::defaultfloat << std::setprecision(6);
+}
+
+#else // !LOCK_PROFILING
+
+class ProfiledMutex : public std::mutex {
+public:
+    explicit ProfiledMutex(const char* = nullptr) {}
+};
+
+#ifdef LOCK_PROFILER_HAS_SEMAPHORE
+template <std::ptrdiff_t LeastMaxValue = 1024>
+class ProfiledSemaphore : public std::counting_semaphore<LeastMaxValue> {
+public:
+    ProfiledSemaphore(const char*, std::ptrdiff_t desired) : std::counting_semaphore<LeastMaxValue>(desired) {}
+};
+#endif
+
+inline void printLockReport(std::ostream&) {}
+
+#endif // LOCK_PROFILING
+
+// Prints the lock report when it goes out of scope. Declared before a thread pool, it prints after the pool has joined
+// its workers, so that their counters are included.
+class LockReportOnExit {
+public:
+    explicit LockReportOnExit(std::ostream& out) : out_(out) {}
+    LockReportOnExit(const LockReportOnExit&) = delete;
+    LockReportOnExit& operator=(const LockReportOnExit&) = delete;
+    ~LockReportOnExit() { printLockReport(out_); }
+
+private:
+    std::ostream& out_;
+};
+
+#endif
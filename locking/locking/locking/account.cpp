@@ -22,4 +22,11 @@ string Account::total()
 	char buf[40];
 	snprintf(buf, sizeof buf, "GBP %u.%02u", pounds_, pence_);
 	return string(buf);
+}
+
+string formatPence(uint64_t pence)
+{
+	char buf[40];
+	snprintf(buf, sizeof buf, "GBP %llu.%02u", (unsigned long long) (pence / 100), (unsigned int) (pence % 100));
+	return string(buf);
 }
\ No newline at end of file
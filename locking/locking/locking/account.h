@@ -1,6 +1,7 @@
 #ifndef ACCOUNT_H
 #define ACCOUNT_H
 
+#include <cstdint>
 #include <string>
 
 /** An Account keeps track of a non-negative amount of money, expressed in
@@ -19,4 +20,8 @@ private:
 	unsigned int pence_ = 0;
 };
 
+/** Format an amount in pence the way Account::total() does (e.g. "GBP
+4.95"), for the accounts that keep their balance as a count of pence. */
+std::string formatPence(uint64_t pence);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#include <string>
+
+#include "account.h"
+#include "atomic_account.h"
+
+using std::string;
+
+void AtomicAccount::add(unsigned int tpounds, unsigned int tpence)
+{
+	// Only the sum matters, not the order of the additions, so relaxed is enough.
+	pence_.fetch_add(uint64_t(tpounds) * 100 + tpence, std::memory_order_relaxed);
+}
+
+uint64_t AtomicAccount::totalPence() const
+{
+	return pence_.load(std::memory_order_relaxed);
+}
+
+string AtomicAccount::total() const
+{
+	return formatPence(totalPence());
+}
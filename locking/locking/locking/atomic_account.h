@@ -0,0 +1,27 @@
+#ifndef ATOMIC_ACCOUNT_H
+#define ATOMIC_ACCOUNT_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/** A thread-safe Account. The balance is kept as a single 64-bit count of
+pence, so adding an amount is one atomic fetch_add: there is no carry
+between separate pounds and pence fields to get wrong, and no lock. */
+class AtomicAccount
+{
+public:
+	/** Add an amount to the total. Safe to call from any number of threads. */
+	void add(unsigned int pounds, unsigned int pence);
+
+	/** Retrieve the total, formatted as a string (e.g. "GBP 4.95"). */
+	std::string total() const;
+
+	/** Retrieve the total in pence. */
+	uint64_t totalPence() const;
+
+private:
+	std::atomic<uint64_t> pence_{0};
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include "account.h"
+#include "ledger.h"
+
+using std::string;
+
+Ledger::Ledger(size_t accounts, uint64_t openingPence, unsigned int stripes)
+	: storage_(accounts + ACCOUNTS_PER_LINE - 1, openingPence), accounts_(accounts)
+{
+	uintptr_t address = reinterpret_cast<uintptr_t>(storage_.data());
+	balances_ = storage_.data() + (LINE_BYTES - address % LINE_BYTES) % LINE_BYTES / sizeof(uint64_t);
+
+	if (stripes == 0) {
+		unsigned int cores = std::thread::hardware_concurrency();
+		stripes = 64 * (cores == 0 ? 1 : cores);
+	}
+	stripes_ = std::vector<Stripe>(stripes);
+}
+
+void Ledger::deposit(size_t account, uint64_t pence)
+{
+	std::lock_guard<ProfiledMutex> lock(stripes_[stripeOf(account)].mutex);
+	balances_[account] += pence;
+}
+
+bool Ledger::applyTransfer(const Transfer& t)
+{
+	if (balances_[t.from] < t.pence) {
+		return false;
+	}
+	balances_[t.from] -= t.pence;
+	balances_[t.to] += t.pence;
+	return true;
+}
+
+bool Ledger::transfer(size_t from, size_t to, uint64_t pence)
+{
+	size_t a = stripeOf(from), b = stripeOf(to);
+	if (a > b) {
+		std::swap(a, b);
+	}
+
+	// Lower stripe first; both accounts may be in the same stripe.
+	std::lock_guard<ProfiledMutex> first(stripes_[a].mutex);
+	if (a == b) {
+		return applyTransfer(Transfer{from, to, pence});
+	}
+	std::lock_guard<ProfiledMutex> second(stripes_[b].mutex);
+	return applyTransfer(Transfer{from, to, pence});
+}
+
+size_t Ledger::transferBatch(const std::vector<Transfer>& batch)
+{
+	// One bit per stripe the batch touches; reading the bits in order gives
+	// the stripes sorted and without repeats, without sorting anything.
+	std::vector<uint64_t> touched((stripes_.size() + 63) / 64, 0);
+	for (const Transfer& t : batch) {
+		touched[stripeOf(t.from) / 64] |= uint64_t(1) << (stripeOf(t.from) % 64);
+		touched[stripeOf(t.to) / 64] |= uint64_t(1) << (stripeOf(t.to) % 64);
+	}
+	auto forEachTouched = [&](auto operation) {
+		for (size_t word = 0; word < touched.size(); word++) {
+			for (size_t bit = 0; bit < 64; bit++) {
+				if (touched[word] & (uint64_t(1) << bit)) {
+					operation(stripes_[word * 64 + bit].mutex);
+				}
+			}
+		}
+	};
+
+	forEachTouched([](ProfiledMutex& mutex) { mutex.lock(); });
+	size_t succeeded = 0;
+	for (const Transfer& t : batch) {
+		succeeded += applyTransfer(t) ? 1 : 0;
+	}
+	forEachTouched([](ProfiledMutex& mutex) { mutex.unlock(); });
+	return succeeded;
+}
+
+uint64_t Ledger::balance(size_t account)
+{
+	std::lock_guard<ProfiledMutex> lock(stripes_[stripeOf(account)].mutex);
+	return balances_[account];
+}
+
+uint64_t Ledger::totalPence()
+{
+	for (Stripe& stripe : stripes_) {
+		stripe.mutex.lock();
+	}
+	uint64_t sum = 0;
+	for (size_t account = 0; account < accounts_; account++) {
+		sum += balances_[account];
+	}
+	for (Stripe& stripe : stripes_) {
+		stripe.mutex.unlock();
+	}
+	return sum;
+}
+
+string Ledger::total()
+{
+	return formatPence(totalPence());
+}
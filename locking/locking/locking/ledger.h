@@ -0,0 +1,92 @@
+#ifndef LEDGER_H
+#define LEDGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../../common/lock_profiler.h"
+
+/** A transfer of an amount in pence from one account to another. */
+struct Transfer
+{
+	size_t from;
+	size_t to;
+	uint64_t pence;
+};
+
+/** A ledger of many accounts that threads transfer money between.
+
+The balances are kept in pence (like AtomicAccount) in one contiguous
+array, 8 bytes per account, so millions of accounts take little memory
+and neighbouring accounts share cache lines. The array starts on a cache
+line, and accounts are guarded by a fixed set of striped locks a line at
+a time: the 8 accounts of line i / 8 belong to stripe (i / 8) % stripes.
+So a cache line is only ever written under its own stripe's lock, and
+threads working on different stripes never fight over a line. Every
+operation takes its stripes in increasing order, so two transfers can
+never each hold a lock the other is waiting for. */
+class Ledger
+{
+public:
+	/** Create accounts accounts, each with the given opening balance, and
+	the given number of lock stripes (0: 64 per hardware thread). */
+	Ledger(size_t accounts, uint64_t openingPence, unsigned int stripes = 0);
+
+	Ledger(const Ledger&) = delete;
+	Ledger& operator=(const Ledger&) = delete;
+
+	size_t size() const { return accounts_; }
+
+	/** Add money to an account from outside the ledger. */
+	void deposit(size_t account, uint64_t pence);
+
+	/** Move money between two accounts as one step: no other operation sees
+	it half done. Fails (and changes nothing) if from has too little. */
+	bool transfer(size_t from, size_t to, uint64_t pence);
+
+	/** Apply a batch of transfers in order, as one step. All the stripes the
+	batch touches are locked once (in increasing order) for the whole batch,
+	instead of twice per transfer, which pays off when transfers share
+	accounts or stripes, as with hot accounts. Returns how many succeeded;
+	those that failed (too little money) change nothing. */
+	size_t transferBatch(const std::vector<Transfer>& batch);
+
+	/** The balance of one account, in pence. */
+	uint64_t balance(size_t account);
+
+	/** Retrieve the sum of all balances, formatted as a string (e.g. "GBP
+	4.95"). Every stripe is locked while the sum is taken, so it is a
+	consistent snapshot: each transfer is either wholly in it or not. */
+	std::string total();
+
+	/** Retrieve the consistent total in pence. */
+	uint64_t totalPence();
+
+private:
+	/** A lock with padding so that no two locks share a cache line. */
+	struct Stripe
+	{
+		ProfiledMutex mutex{"ledger stripe"};
+		char padding[64];
+	};
+
+	static const size_t LINE_BYTES = 64;
+	static const size_t ACCOUNTS_PER_LINE = LINE_BYTES / sizeof(uint64_t);
+
+	size_t stripeOf(size_t account) const { return account / ACCOUNTS_PER_LINE % stripes_.size(); }
+
+	/** Move the money if from has enough; the caller holds both stripes. */
+	bool applyTransfer(const Transfer& t);
+
+	/** The balances, with up to a line's worth of spare room in front so
+	that they can start on a cache line. */
+	std::vector<uint64_t> storage_;
+	uint64_t* balances_;
+	size_t accounts_;
+	std::vector<Stripe> stripes_;
+};
+
+#endif
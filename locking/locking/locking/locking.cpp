@@ -1,19 +1,212 @@
 // Race conditions example
 // Adam Sampson <a.sampson@abertay.ac.uk>
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "../../../common/lock_profiler.h"
 #include "account.h"
+#include "atomic_account.h"
+#include "ledger.h"
+#include "striped_account.h"
 
 // Import things we need from the standard library
 using std::cout;
 using std::endl;
+using std::string;
 
 Account bill;
 
+/** The plain Account made thread-safe the obvious way, with one mutex
+around every call -- the baseline for the concurrent accounts. */
+class LockedAccount
+{
+public:
+	void add(unsigned int pounds, unsigned int pence)
+	{
+		std::lock_guard<ProfiledMutex> lock(mutex_);
+		account_.add(pounds, pence);
+	}
+
+	string total()
+	{
+		std::lock_guard<ProfiledMutex> lock(mutex_);
+		return account_.total();
+	}
+
+private:
+	ProfiledMutex mutex_{"locked account"};
+	Account account_;
+};
+
+/** Run threads threads that each add 1p to a new account adds times, and
+return the additions per second. The threads wait for a common start
+signal, so creating them is not timed. Prints a warning if the final
+total is wrong. */
+template <typename AccountType>
+double hammer(const char *name, unsigned int threads, unsigned int adds)
+{
+	AccountType account;
+	std::atomic<bool> go{false};
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threads; i++) {
+		workers.emplace_back([&] {
+			while (!go.load()) {
+				std::this_thread::yield();
+			}
+			for (unsigned int j = 0; j < adds; j++) {
+				account.add(0, 1);
+			}
+		});
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	go = true;
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	string expected = formatPence(uint64_t(threads) * adds);
+	if (account.total() != expected) {
+		cout << name << ": wrong total " << account.total() << ", expected " << expected << "\n";
+	}
+	return threads * (double) adds / seconds;
+}
+
+/** Compare the accounts with 1, 2, 4, ... up to all hardware threads
+adding to one bill at once. */
+int benchmarkAccounts(unsigned int adds)
+{
+	unsigned int cores = std::thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+	cout << "threads, million adds per second: mutex, atomic, striped\n";
+	for (unsigned int threads = 1; ; threads = threads * 2 < cores ? threads * 2 : cores) {
+		double locked = hammer<LockedAccount>("mutex", threads, adds);
+		double atomic = hammer<AtomicAccount>("atomic", threads, adds);
+		double striped = hammer<StripedAccount>("striped", threads, adds);
+		cout << threads << ", " << locked / 1e6 << ", " << atomic / 1e6 << ", " << striped / 1e6 << "\n";
+		if (threads == cores) {
+			break;
+		}
+	}
+	return 0;
+}
+
+/** Small, fast random number generator (xorshift64*), one per thread. */
+struct Random
+{
+	uint64_t state;
+
+	uint64_t next()
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 2685821657736338717ULL;
+	}
+};
+
+/** Run threads threads that each make transfers random transfers between
+the accounts of ledger, alone or in batches of batchSize, and return the
+transfers per second. With skewed set, 9 in 10 accounts are picked from
+the first 16 (the hot accounts). Prints a warning if money was created
+or lost. */
+double ledgerRun(Ledger& ledger, unsigned int threads, unsigned int transfers, bool skewed, size_t batchSize)
+{
+	uint64_t before = ledger.totalPence();
+	std::atomic<bool> go{false};
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threads; i++) {
+		workers.emplace_back([&, i] {
+			Random random{0x9E3779B97F4A7C15ULL * (i + 1)};
+			auto pick = [&] {
+				uint64_t r = random.next();
+				if (skewed && r % 10 != 0) {
+					return (size_t) ((r >> 8) % 16);
+				}
+				return (size_t) ((r >> 8) % ledger.size());
+			};
+			std::vector<Transfer> batch;
+			while (!go.load()) {
+				std::this_thread::yield();
+			}
+			for (unsigned int j = 0; j < transfers; j++) {
+				Transfer t{pick(), pick(), 1 + random.next() % 100};
+				if (batchSize <= 1) {
+					ledger.transfer(t.from, t.to, t.pence);
+					continue;
+				}
+				batch.push_back(t);
+				if (batch.size() == batchSize || j + 1 == transfers) {
+					ledger.transferBatch(batch);
+					batch.clear();
+				}
+			}
+		});
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	go = true;
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (ledger.totalPence() != before) {
+		cout << "ledger: total changed from " << before << "p to " << ledger.totalPence() << "p\n";
+	}
+	return threads * (double) transfers / seconds;
+}
+
+/** Transfers per second between a million accounts, with 1, 2, 4, ... up
+to all hardware threads, for uniform and skewed choices of accounts, one
+transfer at a time and in batches of 64. */
+int benchmarkLedger(unsigned int transfers)
+{
+	Ledger ledger(1000000, 10000);
+	unsigned int cores = std::thread::hardware_concurrency();
+	if (cores == 0) {
+		cores = 1;
+	}
+	cout << "Ledger of " << ledger.size() << " accounts, total " << ledger.total() << "\n";
+	cout << "threads, million transfers per second: uniform, uniform batched, skewed, skewed batched\n";
+	for (unsigned int threads = 1; ; threads = threads * 2 < cores ? threads * 2 : cores) {
+		cout << threads;
+		for (bool skewed : {false, true}) {
+			for (size_t batchSize : {1, 64}) {
+				cout << ", " << ledgerRun(ledger, threads, transfers, skewed, batchSize) / 1e6;
+			}
+		}
+		cout << "\n";
+		if (threads == cores) {
+			break;
+		}
+	}
+	cout << "Final total " << ledger.total() << "\n";
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
+	// With LOCK_PROFILING, report the locks of whichever mode runs (see lock_profiler.h).
+	LockReportOnExit lockReport(cout);
+
+	// "locking --bench [adds per thread]" runs the account benchmark instead.
+	if (argc > 1 && string(argv[1]) == "--bench") {
+		return benchmarkAccounts(argc > 2 ? (unsigned int) std::stoul(argv[2]) : 1000000);
+	}
+	// "locking --ledger-bench [transfers per thread]" runs the ledger benchmark.
+	if (argc > 1 && string(argv[1]) == "--ledger-bench") {
+		return benchmarkLedger(argc > 2 ? (unsigned int) std::stoul(argv[2]) : 1000000);
+	}
+
 	cout << "Initial: " << bill.total() << "\n";
 
 	bill.add(4, 17);
@@ -0,0 +1,49 @@
+#include <string>
+#include <thread>
+
+#include "account.h"
+#include "striped_account.h"
+
+using std::string;
+
+/** Each thread takes the next number the first time it adds to any
+StripedAccount, and uses it as its cell index from then on, so threads
+are spread evenly over the cells. */
+static unsigned int threadSlot()
+{
+	static std::atomic<unsigned int> nextSlot{0};
+	thread_local unsigned int slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+	return slot;
+}
+
+StripedAccount::StripedAccount(unsigned int stripes)
+{
+	if (stripes == 0) {
+		stripes = 2 * std::thread::hardware_concurrency();
+	}
+	unsigned int count = 1;
+	while (count < stripes) {
+		count *= 2;
+	}
+	cells_ = std::vector<Cell>(count);
+	mask_ = count - 1;
+}
+
+void StripedAccount::add(unsigned int tpounds, unsigned int tpence)
+{
+	cells_[threadSlot() & mask_].pence.fetch_add(uint64_t(tpounds) * 100 + tpence, std::memory_order_relaxed);
+}
+
+uint64_t StripedAccount::totalPence() const
+{
+	uint64_t sum = 0;
+	for (const Cell& cell : cells_) {
+		sum += cell.pence.load(std::memory_order_relaxed);
+	}
+	return sum;
+}
+
+string StripedAccount::total() const
+{
+	return formatPence(totalPence());
+}
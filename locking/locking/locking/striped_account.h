@@ -0,0 +1,46 @@
+#ifndef STRIPED_ACCOUNT_H
+#define STRIPED_ACCOUNT_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** A thread-safe Account for totals that many threads add to at once
+(like Java's LongAdder). The balance is split over several cells, each
+on its own cache line; every thread adds to the cell it was given, so
+threads do not fight over one line, and total() adds up the cells.
+
+Adding is cheaper than with AtomicAccount under contention, but reading
+the total costs one load per cell, and a total read while other threads
+are adding may include some of their additions and not others. */
+class StripedAccount
+{
+public:
+	/** Create an account with the given number of cells (rounded up to a
+	power of two), or twice the number of hardware threads if 0. */
+	explicit StripedAccount(unsigned int stripes = 0);
+
+	/** Add an amount to the total. Safe to call from any number of threads. */
+	void add(unsigned int pounds, unsigned int pence);
+
+	/** Retrieve the total, formatted as a string (e.g. "GBP 4.95"). */
+	std::string total() const;
+
+	/** Retrieve the total in pence. */
+	uint64_t totalPence() const;
+
+private:
+	/** One part of the balance. The padding keeps any two cells at least a
+	cache line apart, wherever the vector happens to be allocated. */
+	struct Cell
+	{
+		std::atomic<uint64_t> pence{0};
+		char padding[128 - sizeof(std::atomic<uint64_t>)];
+	};
+
+	std::vector<Cell> cells_;
+	unsigned int mask_;
+};
+
+#endif